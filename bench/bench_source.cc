@@ -0,0 +1,112 @@
+// Microbenchmark of primary generation: primaries/s of GPS (square_field_gps.mac) against the FocusedRectangleSource
+// (square_field_rect.mac), and a comparison of the sampled distributions. Built with 'make bench_source'.
+// Usage: bench_source [number_of_primaries] [macro_dir]
+
+#include "FocusedRectangleSource.hh"
+
+#include "G4GeneralParticleSource.hh"
+#include "G4VPrimaryGenerator.hh"
+#include "G4UImanager.hh"
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+#include "G4Timer.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <iomanip>
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+struct SourceSample {
+    G4double rate = 0;               // primaries/s
+    G4double sum[5] = {};            // energy [MeV], x, y [mm], u, v at the source
+    G4double sum2[5] = {};
+    std::vector<G4double> ehist;     // energy histogram (fEbins bins up to fEmax)
+};
+
+static const G4int    fEbins = 64;
+static const G4double fEmax  = 6.4*MeV;
+
+static SourceSample Sample(G4VPrimaryGenerator* source, G4long n)
+{
+    SourceSample s;
+    s.ehist.assign(fEbins, 0);
+    G4Timer timer;
+    timer.Start();
+    for (G4long i=0; i<n; ++i) {
+        G4Event event((G4int)i);
+        source->GeneratePrimaryVertex(&event);
+        const G4PrimaryVertex* vertex = event.GetPrimaryVertex(0);
+        const G4PrimaryParticle* particle = vertex->GetPrimary();
+        G4double v[5] = {particle->GetKineticEnergy()/MeV, vertex->GetX0()/mm, vertex->GetY0()/mm,
+            particle->GetMomentumDirection().x(), particle->GetMomentumDirection().y()};
+        for (G4int k=0; k<5; ++k) {
+            s.sum[k] += v[k];
+            s.sum2[k] += v[k]*v[k];
+        }
+        G4int bin = (G4int)(particle->GetKineticEnergy()/fEmax*fEbins);
+        if (bin >= 0 && bin < fEbins) { s.ehist[bin]++; }
+    }
+    timer.Stop();
+    s.rate = n/timer.GetRealElapsed();
+    return s;
+}
+
+int main(int argc, char** argv)
+{
+    G4long n = argc > 1 ? std::atol(argv[1]) : 1000000;
+    G4String dir = argc > 2 ? argv[2] : ".";
+
+    G4Gamma::Definition();
+    G4Electron::Definition();
+    G4Positron::Definition();
+    G4Random::setTheSeed(12345);
+
+    G4UImanager* UI = G4UImanager::GetUIpointer();
+    UI->ApplyCommand("/control/macroPath " + dir);
+    G4GeneralParticleSource* gps = new G4GeneralParticleSource();
+    UI->ApplyCommand("/control/execute square_field_gps.mac");
+    FocusedRectangleSource* rect = FocusedRectangleSource::getInstance();
+    UI->ApplyCommand("/control/execute square_field_rect.mac");
+    rect->Print();
+
+    SourceSample a = Sample(gps, n);
+    SourceSample b = Sample(rect, n);
+
+    const char* names[5] = {"energy [MeV]", "x [mm]", "y [mm]", "u", "v"};
+    G4cout << G4endl << "Primaries: " << n << G4endl;
+    G4cout << "GPS:              " << a.rate << " primaries/s" << G4endl;
+    G4cout << "Rectangle source: " << b.rate << " primaries/s (" << b.rate/a.rate << "x)" << G4endl << G4endl;
+
+    // difference of the means in units of its standard error
+    G4cout << "quantity        mean (GPS)    mean (rect)   z" << G4endl;
+    for (G4int k=0; k<5; ++k) {
+        G4double ma = a.sum[k]/n, mb = b.sum[k]/n;
+        G4double va = a.sum2[k]/n - ma*ma, vb = b.sum2[k]/n - mb*mb;
+        G4double se = std::sqrt((va + vb)/n);
+        G4cout << std::setw(14) << names[k] << "  " << std::setw(12) << ma << "  " << std::setw(12) << mb << "  "
+            << (se > 0 ? (mb - ma)/se : 0.) << G4endl;
+    }
+
+    // two-sample chi-square of the energy histograms
+    G4double chi2 = 0;
+    G4int dof = 0;
+    for (G4int i=0; i<fEbins; ++i) {
+        G4double sum = a.ehist[i] + b.ehist[i];
+        if (sum <= 0) { continue; }
+        chi2 += (a.ehist[i] - b.ehist[i])*(a.ehist[i] - b.ehist[i])/sum;
+        dof++;
+    }
+    G4cout << G4endl << "Energy spectrum: chi2/dof = " << chi2 << "/" << std::max(0, dof-1) << G4endl;
+
+    delete gps;
+    return 0;
+}
@@ -0,0 +1,46 @@
+######################################################################
+# compare_baseline.py
+#
+# Description:  Compare benchmark results (bench/run_bench.sh) against a
+#               stored baseline; exits with status 1 if the throughput of
+#               any workload/thread count dropped by more than the
+#               tolerance
+#
+#               Also used to compare two builds (e.g. WITH_TASKING=OFF/ON)
+#               including their tail idle time
+# Example usage:   'python compare_baseline.py baseline.csv results.csv [tolerance]'
+######################################################################
+
+import sys
+import csv
+
+def load(fname):
+    with open(fname, 'r') as f:
+        return {(row['workload'], int(row['threads']), row.get('pinning', 'none')): row for row in csv.DictReader(f)}
+
+if len(sys.argv) < 3:
+    print('Usage:  compare_baseline.py baseline.csv results.csv [tolerance (0.10)]')
+    sys.exit(1)
+
+baseline = load(sys.argv[1])
+results = load(sys.argv[2])
+tolerance = float(sys.argv[3]) if len(sys.argv) > 3 else 0.10
+
+regressions = 0
+print('{:<20s} {:>8s} {:>8s} {:>14s} {:>14s} {:>9s} {:>16s}'.format('workload', 'threads', 'pinning', 'baseline ev/s', 'ev/s', 'change', 'tail idle [%]'))
+for key, row in sorted(results.items()):
+    if key not in baseline or not row['events_per_s'] or not baseline[key]['events_per_s']:
+        continue
+    base = float(baseline[key]['events_per_s'])
+    rate = float(row['events_per_s'])
+    change = (rate - base)/base
+    flag = ''
+    if change < -tolerance:
+        flag = '  REGRESSION'
+        regressions += 1
+    tail_idle = '{!s} -> {!s}'.format(baseline[key].get('tail_idle_pct') or '-', row.get('tail_idle_pct') or '-')
+    print('{:<20s} {:>8d} {:>8s} {:>14.1f} {:>14.1f} {:>+8.1f}% {:>16s}{!s}'.format(key[0], key[1], key[2], base, rate, 100*change, tail_idle, flag))
+
+if regressions:
+    print('{:d} throughput regression(s) beyond {:.0f}%'.format(regressions, 100*tolerance))
+    sys.exit(1)
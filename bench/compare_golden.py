@@ -0,0 +1,117 @@
+######################################################################
+# compare_golden.py
+#
+# Description:  Statistical comparison of dose3d/photonFluence against
+#               golden volumes (bench/regression.sh). Means and
+#               variances of the mean per history are taken from the
+#               <name>.bin, <name>_sq.bin and histories.txt outputs of a
+#               run with /det/scorer/uncertainty; voxels above a fraction
+#               of the golden maximum are compared by their z-score
+#                 z = (mean - golden mean)/sqrt(var + golden var)
+#               and a run passes if chi2/ndf, mean z and the fraction of
+#               |z| > 4 are within tolerance. Exits with status 1 on
+#               failure.
+#
+#               'store' writes the golden volumes (means and variances)
+#               of a run instead. --quantities restricts the comparison
+#               to the outputs a configuration scores correctly (e.g. not
+#               the passage fluence with Woodcock tracking)
+#
+# Dependencies: Numpy
+# Example usage:   'python compare_golden.py compare run_dir golden.npz geometry_file'
+#                  'python compare_golden.py store run_dir golden.npz geometry_file'
+######################################################################
+
+import sys
+import os
+import argparse
+import numpy as np
+
+QUANTITIES = ['dose3d', 'photonFluence']
+
+def read_dims(geometry):
+    # first three values of the geometry file are the number of voxels: nx ny nz
+    with open(geometry, 'r') as f:
+        nx, ny, nz = [int(x) for x in f.readline().split()[:3]]
+    return nx, ny, nz
+
+def load_bin(path, dims):
+    nx, ny, nz = dims
+    arr = np.fromfile(path, dtype=np.float64)  # stored in double format
+    if arr.size != nx*ny*nz:
+        raise Exception('Expected {:d} voxels but read {:d} voxels from "{!s}"'.format(nx*ny*nz, arr.size, path))
+    return arr.reshape((nz, ny, nx))
+
+def load_run(run_dir, dims, quantities=QUANTITIES):
+    """per-history mean and variance of the mean of each quantity"""
+    with open(os.path.join(run_dir, 'histories.txt'), 'r') as f:
+        n = int(f.readline())
+    if n < 2:
+        raise Exception('Need at least 2 histories in "{!s}"'.format(run_dir))
+    volumes = {}
+    for name in quantities:
+        total = load_bin(os.path.join(run_dir, name + '.bin'), dims)
+        sum2 = load_bin(os.path.join(run_dir, name + '_sq.bin'), dims)
+        mean = total/n
+        var = np.maximum(sum2/n - mean*mean, 0.0)/(n - 1)
+        volumes[name] = (mean, var)
+    return n, volumes
+
+def compare(mean, var, gmean, gvar, threshold):
+    gmax = np.max(gmean)
+    if gmax <= 0:
+        raise Exception('Golden volume is empty')
+    sigma2 = var + gvar
+    mask = (gmean > threshold*gmax) & (sigma2 > 0)
+    z = (mean[mask] - gmean[mask])/np.sqrt(sigma2[mask])
+    return z
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compare dose3d/photonFluence of a run against golden volumes')
+    parser.add_argument('mode', choices=['compare', 'store'])
+    parser.add_argument('run_dir')
+    parser.add_argument('golden')
+    parser.add_argument('geometry')
+    parser.add_argument('--name', default='', help='label of the run in the report')
+    parser.add_argument('--quantities', default=','.join(QUANTITIES),
+                        help='comma-separated outputs to compare ({!s})'.format(','.join(QUANTITIES)))
+    parser.add_argument('--threshold', type=float, default=0.1, help='compare voxels above this fraction of the golden max (0.1)')
+    parser.add_argument('--chi2-max', type=float, default=1.3, help='largest accepted chi2/ndf (1.3)')
+    parser.add_argument('--bias-max', type=float, default=0.25, help='largest accepted |mean z| (0.25)')
+    parser.add_argument('--outliers-max', type=float, default=0.001, help='largest accepted fraction of |z| > 4 (0.001)')
+    args = parser.parse_args()
+
+    dims = read_dims(args.geometry)
+    quantities = QUANTITIES if args.mode == 'store' else [q for q in args.quantities.split(',') if q]
+    unknown = [q for q in quantities if q not in QUANTITIES]
+    if unknown or not quantities:
+        parser.error('--quantities must be a non-empty list of {!s}'.format(', '.join(QUANTITIES)))
+    n, volumes = load_run(args.run_dir, dims, quantities)
+
+    if args.mode == 'store':
+        arrays = {'histories': np.array(n)}
+        for name, (mean, var) in volumes.items():
+            arrays[name] = mean
+            arrays[name + '_var'] = var
+        np.savez_compressed(args.golden, **arrays)
+        print('Stored golden volumes of {:d} histories in "{!s}"'.format(n, args.golden))
+        sys.exit(0)
+
+    # voxels are correlated through the histories that cross them, so chi2/ndf and mean z scatter more than for
+    # independent voxels; the default tolerances allow for that
+    golden = np.load(args.golden)
+    failed = 0
+    for name, (mean, var) in volumes.items():
+        z = compare(mean, var, golden[name], golden[name + '_var'], args.threshold)
+        if z.size == 0:
+            print('{:<20s} {:<14s} no voxels above threshold  FAIL'.format(args.name, name))
+            failed += 1
+            continue
+        chi2 = np.mean(z*z)
+        bias = np.mean(z)
+        outliers = np.count_nonzero(np.abs(z) > 4)/float(z.size)
+        ok = chi2 <= args.chi2_max and abs(bias) <= args.bias_max and outliers <= args.outliers_max
+        failed += 0 if ok else 1
+        print('{:<20s} {:<14s} {:>8d} {:>10.3f} {:>8.3f} {:>8.2f} {:>10.5f}  {!s}'.format(
+            args.name, name, z.size, chi2, bias, np.max(np.abs(z)), outliers, 'PASS' if ok else 'FAIL'))
+    sys.exit(1 if failed else 0)
@@ -0,0 +1,62 @@
+######################################################################
+# fluence_variance.py
+#
+# Description:  Statistical efficiency of the photon fluence estimators
+#               (bench/fluence_variance.sh): relative standard error of
+#               the passage count (photonFluence) and the track-length
+#               estimator (photonFluenceTL) per voxel, from the <name>.bin,
+#               <name>_sq.bin and histories.txt outputs of a run with
+#               /det/scorer/uncertainty and /det/scorer/trackLengthFluence.
+#               Both are compared on the voxels where the passage fluence
+#               is above a fraction of its maximum; the variance ratio is
+#               the number of histories the passage count needs for the
+#               uncertainty of the track-length estimator
+#
+# Dependencies: Numpy
+# Example usage:   'python fluence_variance.py run_dir geometry_file'
+######################################################################
+
+import os
+import argparse
+import numpy as np
+
+def read_dims(geometry):
+    # first three values of the geometry file are the number of voxels: nx ny nz
+    with open(geometry, 'r') as f:
+        nx, ny, nz = [int(x) for x in f.readline().split()[:3]]
+    return nx, ny, nz
+
+def relative_error(run_dir, name, n, size):
+    total = np.fromfile(os.path.join(run_dir, name + '.bin'), dtype=np.float64)
+    sum2 = np.fromfile(os.path.join(run_dir, name + '_sq.bin'), dtype=np.float64)
+    if total.size != size or sum2.size != size:
+        raise Exception('Expected {:d} voxels in "{!s}" and its _sq output'.format(size, name))
+    mean = total/n
+    var = np.maximum(sum2/n - mean*mean, 0.0)/(n - 1)
+    rel = np.full(size, np.inf)
+    np.divide(np.sqrt(var), mean, out=rel, where=mean > 0)
+    return mean, rel
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Compare the variance of the passage and track-length photon fluence')
+    parser.add_argument('run_dir')
+    parser.add_argument('geometry')
+    parser.add_argument('--name', default='', help='label of the run in the report')
+    parser.add_argument('--threshold', type=float, default=0.5, help='compare voxels above this fraction of the max (0.5)')
+    args = parser.parse_args()
+
+    nx, ny, nz = read_dims(args.geometry)
+    with open(os.path.join(args.run_dir, 'histories.txt'), 'r') as f:
+        n = int(f.readline())
+    if n < 2:
+        raise Exception('Need at least 2 histories in "{!s}"'.format(args.run_dir))
+
+    passage, rel_passage = relative_error(args.run_dir, 'photonFluence', n, nx*ny*nz)
+    _, rel_tl = relative_error(args.run_dir, 'photonFluenceTL', n, nx*ny*nz)
+    mask = (passage > args.threshold*np.max(passage)) & np.isfinite(rel_passage) & np.isfinite(rel_tl) & (rel_tl > 0)
+    if not np.any(mask):
+        print('{:<8s} no voxels above threshold'.format(args.name))
+    else:
+        ratio = (rel_passage[mask]/rel_tl[mask])**2
+        print('{:<8s} {:>8d} {:>16.3f} {:>16.3f} {:>14.2f}'.format(args.name, np.count_nonzero(mask),
+            100*np.mean(rel_passage[mask]), 100*np.mean(rel_tl[mask]), np.median(ratio)))
@@ -0,0 +1,41 @@
+#!/bin/bash
+# Compare the statistical uncertainty of the track-length photon fluence (photonFluenceTL) with the passage count
+# (photonFluence) on the benchmark phantoms, from the per-history sums of squares of the same run
+function print_usage() {
+    echo -e "Usage:  $0 executable [number_of_events] [number_of_threads]\n"
+    echo -e "  Options:"
+    echo -e "    executable:          path to the geant4-boilerplate binary"
+    echo -e "    [number_of_events]:  events per phantom (100000)"
+    echo -e "    [number_of_threads]: worker threads (1)"
+}
+
+if (( $# < 1 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "$1")"
+nevents="${2:-100000}"
+nthreads="${3:-1}"
+results_root='./bench_fluence_variance'
+
+mkdir -p "${results_root}"
+python3 "${root_dir}/bench/make_bench_geometry.py" "${results_root}" > /dev/null || exit 1
+
+for phantom in water slab; do
+    geometry="$(readlink -f "${results_root}/bench_${phantom}.txt")"
+    run_dir="${results_root}/${phantom}"
+    echo "Running \"${phantom}\" in \"${run_dir}\""
+    rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+    cp "${root_dir}/bench/fluence_variance.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+    ( cd "${run_dir}" && NTHREADS="${nthreads}" NEVENTS="${nevents}" \
+        "${executable}" "${geometry}" fluence_variance.in > log.txt 2>&1 )
+done
+
+# summary; the variance ratio is the factor in histories that the track-length estimator saves for the same uncertainty
+printf "\n%-8s %8s %16s %16s %14s\n" "phantom" "voxels" "passage SE [%]" "TL SE [%]" "var ratio"
+for phantom in water slab; do
+    python3 "${root_dir}/bench/fluence_variance.py" "${results_root}/${phantom}" "${results_root}/bench_${phantom}.txt" \
+        --name "${phantom}" || printf "%-8s n/a\n" "${phantom}"
+done
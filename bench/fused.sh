@@ -0,0 +1,51 @@
+#!/bin/bash
+# Compare the fused scoring detector against one Geant4 primitive scorer per quantity on the benchmark phantoms:
+# events/sec and dose3d difference (the outputs should agree up to summation order)
+function print_usage() {
+    echo -e "Usage:  $0 executable [number_of_events] [number_of_threads]\n"
+    echo -e "  Options:"
+    echo -e "    executable:          path to the geant4-boilerplate binary"
+    echo -e "    [number_of_events]:  events per detector and phantom (100000)"
+    echo -e "    [number_of_threads]: worker threads (1)"
+}
+
+if (( $# < 1 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "$1")"
+nevents="${2:-100000}"
+nthreads="${3:-1}"
+results_root='./bench_fused'
+
+mkdir -p "${results_root}"
+python3 "${root_dir}/bench/make_bench_geometry.py" "${results_root}" > /dev/null || exit 1
+
+for phantom in water slab; do
+    geometry="$(readlink -f "${results_root}/bench_${phantom}.txt")"
+    for fused in false true; do
+        run_dir="${results_root}/${phantom}_fused_${fused}"
+        echo "Running \"${phantom}\" with fused scoring \"${fused}\" in \"${run_dir}\""
+        rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+        cp "${root_dir}/bench/fused.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+        ( cd "${run_dir}" && FUSED="${fused}" NTHREADS="${nthreads}" NEVENTS="${nevents}" \
+            "${executable}" "${geometry}" fused.in > log.txt 2>&1 )
+    done
+done
+
+# summary against the primitive scorers
+printf "\n%-8s %-8s %12s %10s %14s %14s\n" "phantom" "fused" "events/s" "speedup" "max |dD| [%]" "mean |dD| [%]"
+for phantom in water slab; do
+    ref_dir="${results_root}/${phantom}_fused_false"
+    rate_ref=$(grep -m1 "^Run time:" "${ref_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+    for fused in false true; do
+        run_dir="${results_root}/${phantom}_fused_${fused}"
+        rate=$(grep -m1 "^Run time:" "${run_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+        speedup=$(python3 -c "print('{:.2f}'.format(float('${rate}')/float('${rate_ref}')))" 2>/dev/null)
+        diff=$(python3 "${root_dir}/utils/compare_dose.py" "${ref_dir}/dose3d.bin" "${run_dir}/dose3d.bin" \
+            "${results_root}/bench_${phantom}.txt" --summary 2>/dev/null)
+        printf "%-8s %-8s %12s %10s %s\n" "${phantom}" "${fused}" "${rate:-n/a}" "${speedup:-n/a}" "${diff:-n/a}"
+    done
+done
@@ -0,0 +1,54 @@
+#!/bin/bash
+# Compare one history per event against several (/det/scorer/historiesPerEvent) on the benchmark phantoms at the same
+# number of histories: events/sec, histories/sec, speedup and dose3d difference
+function print_usage() {
+    echo -e "Usage:  $0 executable [number_of_histories] [number_of_threads] [histories_per_event]\n"
+    echo -e "  Options:"
+    echo -e "    executable:            path to the geant4-boilerplate binary"
+    echo -e "    [number_of_histories]: histories per configuration and phantom (100000)"
+    echo -e "    [number_of_threads]:   worker threads (1)"
+    echo -e "    [histories_per_event]: K compared against 1 (8)"
+}
+
+if (( $# < 1 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "$1")"
+nhistories="${2:-100000}"
+nthreads="${3:-1}"
+k="${4:-8}"
+results_root='./bench_histories'
+
+mkdir -p "${results_root}"
+python3 "${root_dir}/bench/make_bench_geometry.py" "${results_root}" > /dev/null || exit 1
+
+for phantom in water slab; do
+    geometry="$(readlink -f "${results_root}/bench_${phantom}.txt")"
+    for histories in 1 "${k}"; do
+        run_dir="${results_root}/${phantom}_K${histories}"
+        echo "Running \"${phantom}\" with ${histories} histories per event in \"${run_dir}\""
+        rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+        cp "${root_dir}/bench/histories.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+        ( cd "${run_dir}" && HISTORIES="${histories}" NTHREADS="${nthreads}" NEVENTS="$(( nhistories/histories ))" \
+            "${executable}" "${geometry}" histories.in > log.txt 2>&1 )
+    done
+done
+
+# summary against one history per event; the speedup is in histories/s
+printf "\n%-8s %4s %12s %14s %10s %14s %14s\n" "phantom" "K" "events/s" "histories/s" "speedup" "max |dD| [%]" "mean |dD| [%]"
+for phantom in water slab; do
+    ref_dir="${results_root}/${phantom}_K1"
+    rate_ref=$(grep -m1 "^Run time:" "${ref_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+    for histories in 1 "${k}"; do
+        run_dir="${results_root}/${phantom}_K${histories}"
+        rate=$(grep -m1 "^Run time:" "${run_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+        hrate=$(python3 -c "print('{:.1f}'.format(float('${rate}')*${histories}))" 2>/dev/null)
+        speedup=$(python3 -c "print('{:.2f}'.format(float('${rate}')*${histories}/float('${rate_ref}')))" 2>/dev/null)
+        diff=$(python3 "${root_dir}/utils/compare_dose.py" "${ref_dir}/dose3d.bin" "${run_dir}/dose3d.bin" \
+            "${results_root}/bench_${phantom}.txt" --summary 2>/dev/null)
+        printf "%-8s %4s %12s %14s %10s %s\n" "${phantom}" "${histories}" "${rate:-n/a}" "${hrate:-n/a}" "${speedup:-n/a}" "${diff:-n/a}"
+    done
+done
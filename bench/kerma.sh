@@ -0,0 +1,46 @@
+#!/bin/bash
+# Compare kerma mode against full transport: events/sec, speedup and kerma3d difference against dose3d
+function print_usage() {
+    echo -e "Usage:  $0 executable geometry_file [number_of_events] [number_of_threads]\n"
+    echo -e "  Options:"
+    echo -e "    executable:          path to the geant4-boilerplate binary"
+    echo -e "    geometry_file:       phantom geometry file (see doc/)"
+    echo -e "    [number_of_events]:  events per mode (100000)"
+    echo -e "    [number_of_threads]: worker threads (1)"
+}
+
+if (( $# < 2 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "$1")"
+geometry="$(readlink -f "$2")"
+nevents="${3:-100000}"
+nthreads="${4:-1}"
+results_root='./bench_kerma'
+
+mkdir -p "${results_root}"
+for kerma in false true; do
+    run_dir="${results_root}/kerma_${kerma}"
+    echo "Running with kerma mode \"${kerma}\" in \"${run_dir}\""
+    rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+    cp "${root_dir}/bench/kerma.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+    ( cd "${run_dir}" && KERMA="${kerma}" NTHREADS="${nthreads}" NEVENTS="${nevents}" \
+        "${executable}" "${geometry}" kerma.in > log.txt 2>&1 )
+done
+
+# summary; differences are relative to the maximum of the full transport dose (mean over voxels >10% of max), and
+# include the buildup region and interfaces where kerma and dose differ by construction
+full_dir="${results_root}/kerma_false"
+kerma_dir="${results_root}/kerma_true"
+rate_full=$(grep -m1 "^Run time:" "${full_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+rate_kerma=$(grep -m1 "^Run time:" "${kerma_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+speedup=$(python3 -c "print('{:.2f}'.format(float('${rate_kerma}')/float('${rate_full}')))" 2>/dev/null)
+diff=$(python3 "${root_dir}/utils/compare_dose.py" "${full_dir}/dose3d.bin" "${kerma_dir}/kerma3d.bin" "${geometry}" --summary)
+printf "\n%-16s %12s %12s\n" "mode" "events/s" "speedup"
+printf "%-16s %12s %12s\n" "full transport" "${rate_full:-n/a}" "1.00"
+printf "%-16s %12s %12s\n" "kerma" "${rate_kerma:-n/a}" "${speedup:-n/a}"
+printf "\n%14s %14s\n" "max |dD| [%]" "mean |dD| [%]"
+echo "${diff}"
@@ -0,0 +1,52 @@
+######################################################################
+# make_bench_geometry.py
+#
+# Description:  Write the phantoms used by the benchmark suite
+#               (bench/run_bench.sh) in the geometry file format read by
+#               DetectorConstruction::ReadPhantom()
+#
+# Dependencies: none
+# Example usage:   'python make_bench_geometry.py output_dir'
+######################################################################
+
+import sys
+import os
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'utils', 'make_phantoms'))
+from materials import *
+
+def write_geometry(fname, mats, voxelsize, iso=(0, 0, 0)):
+    """Args:
+        mats (list[list]): material per voxel in ZYX ordering; shape (nz, ny, nx)
+    """
+    nz, ny, nx = len(mats), len(mats[0]), len(mats[0][0])
+    # isocenter defined at first face along Z-axis
+    center = list(iso)
+    center[2] += (voxelsize[2]*nz/2.)
+    with open(fname, 'w') as fd:
+        fd.write("{:d} {:d} {:d}\n".format(nx, ny, nz))
+        fd.write("{:f} {:f} {:f}\n".format(*voxelsize))
+        fd.write("{:f} {:f} {:f}\n".format(*center))
+        for plane in mats:
+            for row in plane:
+                for mat in row:
+                    fd.write("{:f} {:d} {:d} {:f}\n".format(*mat))
+
+def slab(size, slab_defs):
+    """slab_defs ([(int, material), ...]): thickness (in voxels) and material of each slab along Z"""
+    nx, ny, nz = size
+    mats = []
+    for thickness, mat in slab_defs:
+        mats += [[[mat]*nx]*ny]*thickness
+    assert len(mats) == nz
+    return mats
+
+if __name__ == "__main__":
+    outdir = sys.argv[1] if len(sys.argv) > 1 else '.'
+    os.makedirs(outdir, exist_ok=True)
+
+    # properties defined as (X,Y,Z); kept small so that initialization does not dominate the benchmark
+    size = (50, 50, 60)
+    voxelsize = (4, 4, 4) # mm
+    write_geometry(os.path.join(outdir, 'bench_water.txt'), slab(size, [(60, water)]), voxelsize)
+    write_geometry(os.path.join(outdir, 'bench_slab.txt'), slab(size, [(10, water), (5, bone), (20, icrp_lung_inflated), (25, water)]), voxelsize)
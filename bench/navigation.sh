@@ -0,0 +1,78 @@
+#!/bin/bash
+# Fire geantinos through the phantom for each geometry representation (/det/phantomType): steps per track, navigation
+# time per step and ComputeMaterial calls per step. The navigation time is the run time per step above a baseline run
+# through a single-voxel phantom of the same extent, which has the per-event and per-track costs but almost no steps
+function print_usage() {
+    echo -e "Usage:  $0 executable geometry_file [number_of_events] [number_of_threads] [particle]\n"
+    echo -e "  Options:"
+    echo -e "    executable:          path to the geant4-boilerplate binary"
+    echo -e "    geometry_file:       phantom geometry file (see doc/)"
+    echo -e "    [number_of_events]:  events per representation (1000000)"
+    echo -e "    [number_of_threads]: worker threads (1)"
+    echo -e "    [particle]:          geantino or chargedgeantino (geantino)"
+}
+
+if (( $# < 2 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "$1")"
+geometry="$(readlink -f "$2")"
+nevents="${3:-1000000}"
+nthreads="${4:-1}"
+particle="${5:-geantino}"
+results_root='./bench_navigation'
+types='nested regular regularSkip'
+
+mkdir -p "${results_root}"
+
+# baseline phantom: one voxel spanning the phantom (the material of its first voxel does not matter for geantinos)
+baseline_geometry="$(readlink -f "${results_root}")/baseline.txt"
+python3 - "${geometry}" "${baseline_geometry}" <<'EOF_PY' || exit 1
+import sys
+with open(sys.argv[1], 'r') as f:
+    n = [int(x) for x in f.readline().split()[:3]]
+    d = [float(x) for x in f.readline().split()[:3]]
+    center = f.readline()
+    voxel = f.readline()
+with open(sys.argv[2], 'w') as f:
+    f.write('1 1 1\n')
+    f.write('{:f} {:f} {:f}\n'.format(*[ni*di for ni, di in zip(n, d)]))
+    f.write(center)
+    f.write(voxel)
+EOF_PY
+run_dir="${results_root}/baseline"
+echo "Running ${particle}s through the single-voxel baseline phantom in \"${run_dir}\""
+rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+cp "${root_dir}/bench/navigation.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+( cd "${run_dir}" && PHANTOM_TYPE="nested" PARTICLE="${particle}" NTHREADS="${nthreads}" NEVENTS="${nevents}" \
+    "${executable}" "${baseline_geometry}" navigation.in > log.txt 2>&1 )
+
+for type in ${types}; do
+    run_dir="${results_root}/${type}"
+    echo "Running ${particle}s through the \"${type}\" phantom in \"${run_dir}\""
+    rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+    cp "${root_dir}/bench/navigation.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+    ( cd "${run_dir}" && PHANTOM_TYPE="${type}" PARTICLE="${particle}" NTHREADS="${nthreads}" NEVENTS="${nevents}" \
+        "${executable}" "${geometry}" navigation.in > log.txt 2>&1 )
+done
+
+# summary from the "Navigation (<type> phantom): ..." line printed at the end of each run. "total ns/step" is the run
+# time of all threads over all steps, including stepping and the (empty) scoring of geantino steps; "nav ns/step" is
+# the thread time above the baseline over the steps above the baseline, i.e. the cost of a step between voxels
+base_line=$(grep -m1 "^Navigation (" "${results_root}/baseline/log.txt")
+base_steps=$(echo "${base_line}" | sed -n 's/.*, \([0-9]*\) steps in.*/\1/p')
+base_time=$(echo "${base_line}" | sed -n 's/.* steps in \([0-9.e+-]*\) s thread time.*/\1/p')
+printf "\n%-14s %14s %14s %14s %20s\n" "phantom" "steps/track" "total ns/step" "nav ns/step" "ComputeMaterial/step"
+for type in ${types}; do
+    line=$(grep -m1 "^Navigation (" "${results_root}/${type}/log.txt")
+    steps=$(echo "${line}" | sed -n 's/.*: \([0-9.e+-]*\) steps\/track.*/\1/p')
+    total_steps=$(echo "${line}" | sed -n 's/.*, \([0-9]*\) steps in.*/\1/p')
+    thread_time=$(echo "${line}" | sed -n 's/.* steps in \([0-9.e+-]*\) s thread time.*/\1/p')
+    time=$(echo "${line}" | sed -n 's/.*, \([0-9.e+-]*\) ns\/step.*/\1/p')
+    calls=$(echo "${line}" | sed -n 's/.*, \([0-9.e+-]*\) ComputeMaterial.*/\1/p')
+    nav=$(python3 -c "print('{:.2f}'.format(1e9*(float('${thread_time}') - float('${base_time}'))/(int('${total_steps}') - int('${base_steps}'))))" 2>/dev/null)
+    printf "%-14s %14s %14s %14s %20s\n" "${type}" "${steps:-n/a}" "${time:-n/a}" "${nav:-n/a}" "${calls:-n/a}"
+done
@@ -0,0 +1,48 @@
+#!/bin/bash
+# Compare physics profiles: initialization time, events/sec and dose difference against the reference profile
+function print_usage() {
+    echo -e "Usage:  $0 executable geometry_file [number_of_events] [number_of_threads]\n"
+    echo -e "  Options:"
+    echo -e "    executable:          path to the geant4-boilerplate binary"
+    echo -e "    geometry_file:       phantom geometry file (see doc/)"
+    echo -e "    [number_of_events]:  events per profile (100000)"
+    echo -e "    [number_of_threads]: worker threads (1)"
+}
+
+if (( $# < 2 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "$1")"
+geometry="$(readlink -f "$2")"
+nevents="${3:-100000}"
+nthreads="${4:-1}"
+results_root='./bench_physics_profiles'
+
+# profile:em pairs; the first entry is the reference
+profiles=("reference:opt3" "lean-photon:opt3" "lean-photon:opt0" "lean-photon:opt4" "lean-photon:livermore")
+
+mkdir -p "${results_root}"
+for entry in "${profiles[@]}"; do
+    profile="${entry%%:*}"
+    em="${entry##*:}"
+    run_dir="${results_root}/${profile}_${em}"
+    echo "Running profile \"${profile}\" with EM \"${em}\" in \"${run_dir}\""
+    rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+    cp "${root_dir}/bench/physics_profile.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+    ( cd "${run_dir}" && PROFILE="${profile}" EM="${em}" NTHREADS="${nthreads}" NEVENTS="${nevents}" \
+        "${executable}" "${geometry}" physics_profile.in > log.txt 2>&1 )
+done
+
+# summary
+ref_dir="${results_root}/${profiles[0]%%:*}_${profiles[0]##*:}"
+printf "\n%-24s %12s %12s %14s %14s\n" "profile" "init [s]" "events/s" "max |dD| [%]" "mean |dD| [%]"
+for entry in "${profiles[@]}"; do
+    run_dir="${results_root}/${entry%%:*}_${entry##*:}"
+    init_time=$(grep -m1 "^Initialization time:" "${run_dir}/log.txt" | awk '{print $3}')
+    rate=$(grep -m1 "^Run time:" "${run_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+    diff=$(python3 "${root_dir}/utils/compare_dose.py" "${ref_dir}/dose3d.bin" "${run_dir}/dose3d.bin" "${geometry}" --summary)
+    printf "%-24s %12s %12s %s\n" "${entry}" "${init_time:-n/a}" "${rate:-n/a}" "${diff}"
+done
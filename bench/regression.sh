@@ -0,0 +1,115 @@
+#!/bin/bash
+# Dose regression test: runs reference configurations with fixed seeds and compares dose3d and photonFluence per voxel
+# against the golden volumes in bench/golden/ (z-scores from the per-history uncertainties, see bench/compare_golden.py).
+# Configurations with a fast path (regular phantom, Woodcock tracking, weight windows, several histories per event) are
+# compared against the golden volumes of the reference configuration on the same phantom, on the quantities they score
+# correctly: Woodcock photons do not stop at voxel boundaries, so their passage fluence (photonFluence) is not compared.
+# Missing golden volumes are generated from the reference configurations on the first run, with another seed than the
+# compared runs; --update-golden regenerates all of them.
+function print_usage() {
+    echo -e "Usage:  $0 executable [number_of_histories] [number_of_threads] [--update-golden]\n"
+    echo -e "  Options:"
+    echo -e "    executable:            path to the geant4-boilerplate binary"
+    echo -e "    [number_of_histories]: histories per configuration (200000)"
+    echo -e "    [number_of_threads]:   worker threads (4)"
+    echo -e "    --update-golden:       store the reference configurations as the new golden volumes instead of"
+    echo -e "                           comparing; only from a build whose dose is trusted"
+}
+
+update_golden=0
+args=()
+for arg in "$@"; do
+    if [[ "${arg}" == "--update-golden" ]]; then update_golden=1; else args+=("${arg}"); fi
+done
+if (( ${#args[@]} < 1 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "${args[0]}")"
+nhistories="${args[1]:-200000}"
+nthreads="${args[2]:-4}"
+results_root='./regression_results'
+golden_dir="${root_dir}/bench/golden"
+# golden volumes and compared runs are independent samples
+golden_seed=54321
+seed=12345
+
+mkdir -p "${results_root}"
+results_root="$(readlink -f "${results_root}")" # runs start in their own directory
+python3 "${root_dir}/bench/make_bench_geometry.py" "${results_root}" > /dev/null || exit 1
+
+# name:geometry:golden:phantom_type:woodcock:weight_window:histories_per_event:quantities; the golden volumes are
+# stored from the configurations that are their own golden
+configs=("water:bench_water.txt:water:nested:false:false:1:dose3d,photonFluence"
+         "slab:bench_slab.txt:slab:nested:false:false:1:dose3d,photonFluence"
+         "slab_regular:bench_slab.txt:slab:regular:false:false:1:dose3d,photonFluence"
+         "slab_woodcock:bench_slab.txt:slab:nested:true:false:1:dose3d"
+         "slab_weightwindow:bench_slab.txt:slab:nested:false:true:1:dose3d,photonFluence"
+         "slab_histories:bench_slab.txt:slab:nested:false:false:8:dose3d,photonFluence")
+
+# run_config run_dir seed: runs the configuration read from ${entry}; fails if it did not write its outputs
+function run_config() {
+    local run_dir="$1"
+    echo "Running configuration \"${name}\" in \"${run_dir}\" (seed $2)"
+    rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+    cp "${root_dir}/bench/regression.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+    ( cd "${run_dir}" && PHANTOM_TYPE="${phantom_type}" WOODCOCK="${woodcock}" WEIGHT_WINDOW="${weight_window}" \
+        HISTORIES="${histories}" NTHREADS="${nthreads}" NEVENTS="$(( nhistories/histories ))" SEED="$2" \
+        "${executable}" "$(readlink -f "${results_root}/${geometry}")" regression.in > log.txt 2>&1 )
+    if [[ ! -f "${run_dir}/histories.txt" ]]; then
+        echo "Configuration \"${name}\" did not write its outputs; see \"${run_dir}/log.txt\""
+        return 1
+    fi
+}
+
+# golden volumes: all reference configurations with --update-golden, otherwise only the missing ones (first run)
+failed=0
+for entry in "${configs[@]}"; do
+    IFS=':' read -r name geometry golden phantom_type woodcock weight_window histories quantities <<< "${entry}"
+    [[ "${name}" != "${golden}" ]] && continue
+    (( ! update_golden )) && [[ -f "${golden_dir}/${golden}.npz" ]] && continue
+    if (( ! update_golden )); then
+        echo "No golden volumes \"${golden_dir}/${golden}.npz\": generating them from this build. They are only a reference"
+        echo "  for later builds if this build's dose is trusted; commit bench/golden/ once it is."
+    fi
+    run_dir="${results_root}/golden_${name}"
+    if run_config "${run_dir}" "${golden_seed}"; then
+        mkdir -p "${golden_dir}"
+        python3 "${root_dir}/bench/compare_golden.py" store "${run_dir}" "${golden_dir}/${golden}.npz" \
+            "${results_root}/${geometry}" || failed=1
+    else
+        failed=1
+    fi
+done
+(( update_golden )) && exit ${failed}
+
+report=()
+for entry in "${configs[@]}"; do
+    IFS=':' read -r name geometry golden phantom_type woodcock weight_window histories quantities <<< "${entry}"
+    run_dir="${results_root}/${name}"
+    if ! run_config "${run_dir}" "${seed}"; then
+        report+=("$(printf '%-20s %-14s %s' "${name}" "-" "FAIL (no output)")")
+        failed=1
+        continue
+    fi
+
+    if [[ -f "${golden_dir}/${golden}.npz" ]]; then
+        report+=("$(python3 "${root_dir}/bench/compare_golden.py" compare "${run_dir}" "${golden_dir}/${golden}.npz" \
+            "${results_root}/${geometry}" --name "${name}" --quantities "${quantities}")") || failed=1
+    else
+        report+=("$(printf '%-20s %-14s %s' "${name}" "-" "FAIL (no golden \"${golden_dir}/${golden}.npz\")")")
+        failed=1
+    fi
+done
+
+printf "\n%-20s %-14s %8s %10s %8s %8s %10s  %s\n" "configuration" "quantity" "voxels" "chi2/ndf" "mean z" "max|z|" "|z|>4" "result"
+printf "%s\n" "${report[@]}"
+echo ''
+if (( failed )); then
+    echo "Regression test FAILED"
+else
+    echo "Regression test passed"
+fi
+exit ${failed}
@@ -0,0 +1,81 @@
+#!/bin/bash
+# End-to-end throughput benchmark: events/s, thread-scaling efficiency, tail idle time, peak RSS and initialization time
+# per workload
+function print_usage() {
+    echo -e "Usage:  $0 executable [max_threads] [number_of_events] [--update-baseline]\n"
+    echo -e "  Options:"
+    echo -e "    executable:          path to the geant4-boilerplate binary"
+    echo -e "    [max_threads]:       largest thread count; runs 1, 2, 4, ... up to this (number of cores)"
+    echo -e "    [number_of_events]:  events per run (20000)"
+    echo -e "    --update-baseline:   store the results as the new baseline instead of comparing"
+    echo -e "  Environment:"
+    echo -e "    BENCH_PINNING:       space separated worker pinning policies to compare (\"none\"); e.g. \"none core node\""
+}
+
+update_baseline=0
+args=()
+for arg in "$@"; do
+    if [[ "${arg}" == "--update-baseline" ]]; then update_baseline=1; else args+=("${arg}"); fi
+done
+if (( ${#args[@]} < 1 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "${args[0]}")"
+max_threads="${args[1]:-$(nproc)}"
+nevents="${args[2]:-20000}"
+pinnings=(${BENCH_PINNING:-none})
+results_root='./bench_results'
+results_file="${results_root}/results.csv"
+baseline_file="${root_dir}/bench/baseline.csv"
+
+mkdir -p "${results_root}"
+python3 "${root_dir}/bench/make_bench_geometry.py" "${results_root}" > /dev/null || exit 1
+
+thread_counts=()
+for (( t=1; t<max_threads; t*=2 )); do thread_counts+=("${t}"); done
+thread_counts+=("${max_threads}")
+
+# workload:geometry:tracked_beamlets
+workloads=("water_gps:bench_water.txt:0" "slab_gps:bench_slab.txt:0" "water_beamlets:bench_water.txt:1")
+
+echo "workload,threads,pinning,events,init_s,events_per_s,efficiency,tail_idle_pct,peak_rss_mb" > "${results_file}"
+for entry in "${workloads[@]}"; do
+    IFS=':' read -r workload geometry beamlets <<< "${entry}"
+    for pinning in "${pinnings[@]}"; do
+        rate1=''
+        for nthreads in "${thread_counts[@]}"; do
+            run_dir="${results_root}/${workload}_${pinning}_t${nthreads}"
+            echo "Running workload \"${workload}\" with ${nthreads} thread(s), pinning \"${pinning}\" in \"${run_dir}\""
+            rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+            cp "${root_dir}/bench/workload.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+            # Run reads tracked beamlets from the working directory
+            (( beamlets )) && cp "${root_dir}/tracked_beamlets.txt" "${run_dir}/"
+            ( cd "${run_dir}" && NTHREADS="${nthreads}" NEVENTS="${nevents}" PINNING="${pinning}" \
+                "${executable}" "$(readlink -f "${results_root}/${geometry}")" workload.in > log.txt 2>&1 )
+
+            init_time=$(grep -m1 "^Initialization time:" "${run_dir}/log.txt" | awk '{print $3}')
+            rate=$(grep -m1 "^Run time:" "${run_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+            rss=$(grep -m1 "^Peak RSS:" "${run_dir}/log.txt" | awk '{print $3}')
+            tail_idle=$(grep -m1 "^Tail idle" "${run_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\)% of worker time).*/\1/')
+            [[ -z "${rate1}" ]] && rate1="${rate}"
+            efficiency=$(python3 -c "print('{:.3f}'.format(float('${rate}')/(${nthreads}*float('${rate1}'))))" 2>/dev/null)
+            echo "${workload},${nthreads},${pinning},${nevents},${init_time},${rate},${efficiency},${tail_idle},${rss}" >> "${results_file}"
+        done
+    done
+done
+
+echo ''
+column -s, -t < "${results_file}"
+echo ''
+
+if (( update_baseline )); then
+    cp "${results_file}" "${baseline_file}"
+    echo "Stored baseline \"${baseline_file}\""
+elif [[ -f "${baseline_file}" ]]; then
+    python3 "${root_dir}/bench/compare_baseline.py" "${baseline_file}" "${results_file}"
+else
+    echo "No baseline found at \"${baseline_file}\"; rerun with --update-baseline to store one"
+fi
@@ -0,0 +1,54 @@
+#!/bin/bash
+# Check that the photon weight windows (/det/vr/weightWindow) leave the mean dose and photon fluence unchanged: the
+# slab phantom is run with the window off and on (independent seeds), and the second run is compared to the first per
+# voxel by z-score (bench/compare_golden.py); also reports events/sec of both. Exits with status 1 on a difference.
+function print_usage() {
+    echo -e "Usage:  $0 executable [number_of_histories] [number_of_threads]\n"
+    echo -e "  Options:"
+    echo -e "    executable:            path to the geant4-boilerplate binary"
+    echo -e "    [number_of_histories]: histories per run (200000)"
+    echo -e "    [number_of_threads]:   worker threads (4)"
+}
+
+if (( $# < 1 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "$1")"
+nhistories="${2:-200000}"
+nthreads="${3:-4}"
+results_root='./bench_weightwindow'
+
+mkdir -p "${results_root}"
+results_root="$(readlink -f "${results_root}")"
+python3 "${root_dir}/bench/make_bench_geometry.py" "${results_root}" > /dev/null || exit 1
+geometry="${results_root}/bench_slab.txt"
+
+seed=12345
+for window in false true; do
+    run_dir="${results_root}/window_${window}"
+    echo "Running the slab phantom with weight windows \"${window}\" in \"${run_dir}\""
+    rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+    cp "${root_dir}/bench/regression.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+    ( cd "${run_dir}" && PHANTOM_TYPE="nested" WOODCOCK="false" WEIGHT_WINDOW="${window}" HISTORIES="1" \
+        NTHREADS="${nthreads}" NEVENTS="${nhistories}" SEED="${seed}" "${executable}" "${geometry}" regression.in > log.txt 2>&1 )
+    if [[ ! -f "${run_dir}/histories.txt" ]]; then
+        echo "Run \"${run_dir}\" did not write its outputs; see \"${run_dir}/log.txt\""
+        exit 1
+    fi
+    seed=54321
+done
+
+printf "\n%-10s %12s\n" "window" "events/s"
+for window in false true; do
+    rate=$(grep -m1 "^Run time:" "${results_root}/window_${window}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+    printf "%-10s %12s\n" "${window}" "${rate:-n/a}"
+done
+
+python3 "${root_dir}/bench/compare_golden.py" store "${results_root}/window_false" "${results_root}/window_false.npz" \
+    "${geometry}" > /dev/null || exit 1
+printf "\n%-20s %-14s %8s %10s %8s %8s %10s  %s\n" "configuration" "quantity" "voxels" "chi2/ndf" "mean z" "max|z|" "|z|>4" "result"
+python3 "${root_dir}/bench/compare_golden.py" compare "${results_root}/window_true" "${results_root}/window_false.npz" \
+    "${geometry}" --name "window_true"
@@ -0,0 +1,53 @@
+#!/bin/bash
+# Compare Woodcock photon tracking against voxel-by-voxel stepping on the benchmark phantoms: events/sec, steps in the
+# phantom region and dose3d difference
+function print_usage() {
+    echo -e "Usage:  $0 executable [number_of_events] [number_of_threads]\n"
+    echo -e "  Options:"
+    echo -e "    executable:          path to the geant4-boilerplate binary"
+    echo -e "    [number_of_events]:  events per mode and phantom (100000)"
+    echo -e "    [number_of_threads]: worker threads (1)"
+}
+
+if (( $# < 1 )); then
+    print_usage
+    exit 1
+fi
+
+root_dir="$(cd "$(dirname "$0")/.." && pwd)"
+executable="$(readlink -f "$1")"
+nevents="${2:-100000}"
+nthreads="${3:-1}"
+results_root='./bench_woodcock'
+
+mkdir -p "${results_root}"
+python3 "${root_dir}/bench/make_bench_geometry.py" "${results_root}" > /dev/null || exit 1
+
+for phantom in water slab; do
+    geometry="$(readlink -f "${results_root}/bench_${phantom}.txt")"
+    for woodcock in false true; do
+        run_dir="${results_root}/${phantom}_woodcock_${woodcock}"
+        echo "Running \"${phantom}\" with Woodcock tracking \"${woodcock}\" in \"${run_dir}\""
+        rm -rf "${run_dir}" && mkdir -p "${run_dir}"
+        cp "${root_dir}/bench/woodcock.in" "${root_dir}/square_field_gps.mac" "${root_dir}/spectrum_varian6X.mac" "${run_dir}/"
+        ( cd "${run_dir}" && WOODCOCK="${woodcock}" NTHREADS="${nthreads}" NEVENTS="${nevents}" \
+            "${executable}" "${geometry}" woodcock.in > log.txt 2>&1 )
+    done
+done
+
+# summary; steps are those of all particles in the phantom region (SteppingAction), of which Woodcock tracking only
+# removes the photon steps at voxel boundaries
+printf "\n%-8s %-10s %12s %16s %10s %14s %14s\n" "phantom" "woodcock" "events/s" "phantom steps" "speedup" "max |dD| [%]" "mean |dD| [%]"
+for phantom in water slab; do
+    ref_dir="${results_root}/${phantom}_woodcock_false"
+    rate_ref=$(grep -m1 "^Run time:" "${ref_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+    for woodcock in false true; do
+        run_dir="${results_root}/${phantom}_woodcock_${woodcock}"
+        rate=$(grep -m1 "^Run time:" "${run_dir}/log.txt" | sed 's/.*(\([0-9.e+-]*\) events\/s).*/\1/')
+        steps=$(grep -m1 "^  phantom " "${run_dir}/log.txt" | awk '{print $2}')
+        speedup=$(python3 -c "print('{:.2f}'.format(float('${rate}')/float('${rate_ref}')))" 2>/dev/null)
+        diff=$(python3 "${root_dir}/utils/compare_dose.py" "${ref_dir}/dose3d.bin" "${run_dir}/dose3d.bin" \
+            "${results_root}/bench_${phantom}.txt" --summary 2>/dev/null)
+        printf "%-8s %-10s %12s %16s %10s %s\n" "${phantom}" "${woodcock}" "${rate:-n/a}" "${steps:-n/a}" "${speedup:-n/a}" "${diff:-n/a}"
+    done
+done
@@ -0,0 +1,98 @@
+#ifndef Checkpoint_h
+#define Checkpoint_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <set>
+#include <mutex>
+
+class CheckpointMessenger;
+
+/* Checkpoint/restart for jobs that may be preempted.
+ * With --checkpoint <dir> or --resume <dir>, main.cc runs its macros through ExecuteMacro() instead of /control/execute,
+ *   which keeps count of the /run/beamOn commands. A checkpoint holds everything needed to continue the job exactly:
+ *   the number of completed beamOn commands and the events still missing from the next one, the event count, the
+ *   master RNG engine state (worker engines are reseeded from it at the start of every run), the phase-space cursor of
+ *   every worker, and copies of all cumulative output files at that point.
+ * A checkpoint is written at the end of a run once <interval> seconds have passed since the previous one (after every
+ *   run if 0), and whenever a run is interrupted. When the interval elapses during a run, or on SIGTERM/SIGUSR1, each
+ *   worker stops after its current event (soft abort) and the checkpoint is taken. After an interval the rest of the
+ *   run is issued as a new beamOn; after a signal the job stops and main() exits with status 75 (EX_TEMPFAIL).
+ * Checkpoints are written to <dir>.tmp and swapped in by renaming, so <dir> (or <dir>.old, if the process died between
+ *   the two renames) always holds a complete one.
+ * Resume() copies the outputs back and reads the counters. ExecuteMacro() then replays all other commands so that
+ *   geometry, source and physics are set up as before, skips completed beamOn commands, restores the RNG state and
+ *   event count right before the first beamOn it runs, and runs only the missing events of an interrupted one.
+ *   Only beamOn commands in macros executed with /control/execute are counted (not /control/loop or /control/foreach).
+ */
+class Checkpoint
+{
+    public:
+        static Checkpoint* getInstance();
+        static Checkpoint* instance;
+        ~Checkpoint();
+
+        void SetInterval(G4double seconds) { fInterval = seconds; }
+
+        // enable checkpointing to <dir>; with resume, continue from the checkpoint found there
+        G4bool Start(const G4String& dir, G4bool resume);
+        G4bool IsEnabled() const { return !fDir.empty(); }
+
+        // false if a command failed or the job was stopped by a signal
+        G4bool ExecuteMacro(const G4String& fname);
+        G4bool IsStopped() const { return fStopped; }
+
+        // output files to include in the checkpoint (registered by the master RunAction as they are written)
+        void AddOutput(const G4String& fname);
+
+        // per-worker source state, saved by the worker RunActions at the end of each run
+        void SetThreadState(G4int threadID, const G4String& state);
+        G4bool TakeThreadState(G4int threadID, G4String& state);
+
+        // polled by the EventAction after every event
+        inline G4bool InterruptRequested() const {
+            if (sSignal.load(std::memory_order_relaxed) != 0) { return true; }
+            std::chrono::steady_clock::rep deadline = fDeadline.load(std::memory_order_relaxed);
+            return deadline != 0 && std::chrono::steady_clock::now().time_since_epoch().count() >= deadline;
+        }
+
+    private:
+        Checkpoint();
+        static void HandleSignal(int signum);
+
+        G4bool BeamOn(const G4String& args);
+        G4bool Read(const G4String& dir);
+        void Write();
+        void RestoreState();
+
+        static std::atomic<int> sSignal;
+
+        CheckpointMessenger* fMessenger;
+        G4String fDir;       // empty: checkpointing disabled
+        G4double fInterval;  // [s]; 0 writes a checkpoint after every run
+        std::chrono::steady_clock::time_point fLastWrite;
+        std::atomic<std::chrono::steady_clock::rep> fDeadline; // 0 while no interval is armed
+        G4bool fStopped;
+
+        // progress through the macros
+        G4int  fRunIndex;  // beamOn commands seen so far
+        G4long fRemaining; // events still to run for beamOn #fRunIndex
+
+        // state read by Resume(), applied before the first beamOn that is run
+        G4bool fRestorePending;
+        G4String fRestoreDir;
+        G4int  fResumeRuns;
+        G4long fResumeRemaining;
+        long int fResumeEvents;
+        G4int  fResumeThreads;
+
+        std::set<G4String> fOutputs;
+        std::map<G4int, G4String> fThreadStates;  // as of the last run
+        std::map<G4int, G4String> fPendingStates; // read by Resume(), not yet handed back to the workers
+        std::mutex fMutex;
+};
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef CheckpointMessenger_h
+#define CheckpointMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class Checkpoint;
+class G4UIdirectory;
+class G4UIcmdWithADoubleAndUnit;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+class CheckpointMessenger: public G4UImessenger
+{
+  public:
+
+    CheckpointMessenger(Checkpoint* );
+   ~CheckpointMessenger();
+
+    void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+	G4UIdirectory				*Dir;
+    Checkpoint					*fCheckpoint;
+    G4UIcmdWithADoubleAndUnit   *intervalCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -4,6 +4,11 @@
 #include "G4VUserDetectorConstruction.hh"
 #include "globals.hh"
 #include "G4ThreeVector.hh"
+#include "ImportanceMap.hh"
+#include "KermaTable.hh"
+#include "RegionOfInterest.hh"
+#include "SparseSpectra.hh"
+#include "Span.hh"
 #include <vector>
 #include <list>
 #include <map>
@@ -11,6 +16,8 @@
 class DetectorMessenger;
 class G4Material;
 class G4NistManager;
+class G4MultiFunctionalDetector;
+class ScoringWorld;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 struct matStruct {
@@ -18,6 +25,15 @@ struct matStruct {
 	G4int numMat, matID1, matID2;
 };
 
+//In-memory phantom (instead of a geometry file); the arrays are read by Construct() and must stay valid until then
+struct PhantomSpec {
+	G4int nx, ny, nz;
+	G4double dx, dy, dz;				//voxel size (mm)
+	G4double px, py, pz;				//position of array center (mm)
+	Span<const G4float> density;		//g/cm3, ZYX ordering (x fastest)
+	Span<const G4int> material;			//base material index per voxel, as in geometry files (see doc/materials.txt)
+};
+
 
 class DetectorConstruction : public G4VUserDetectorConstruction
 {
@@ -31,6 +47,45 @@ class DetectorConstruction : public G4VUserDetectorConstruction
 		static DetectorConstruction* instance;
 		DetectorMessenger			*dMess;
 
+		// use an in-memory phantom for the next Construct(); /det/geo switches back to geometry files
+		void SetPhantom(const PhantomSpec& spec);
+		G4bool HasMemoryPhantom() const { return fMemoryPhantom; }
+
+		void BuildImportanceMap();
+		ImportanceMap& GetImportanceMap() { return fImportanceMap; }
+		const RegionOfInterest& GetRegionOfInterest() const { return fRoi; }
+		KermaTable& GetKermaTable() { return fKermaTable; }
+		G4bool IsKermaRun() const { return fKermaTable.IsEnabled(); }	//dose3d is not written in kerma runs
+
+		// air gap handling: primaries can be moved to the phantom surface, and the world sized to phantom + source
+		G4bool IsFastForward() const { return fFastForward; }
+		G4bool IsAirAttenuation() const { return fAirAttenuation; }
+		void GetPhantomBounds(G4ThreeVector& lo, G4ThreeVector& hi) const;
+		const G4Material* GetWorldMaterial() const { return G4Air; }
+
+		// phantom dimensions of the current geometry file (valid after Construct())
+		G4int GetNx() const { return nx; }
+		G4int GetNy() const { return ny; }
+		G4int GetNz() const { return nz; }
+		G4int GetConstructCount() const { return fConstructCount; }	//incremented on every (re)build of the geometry
+
+		// geometry representation of the phantom: "nested" replicas (default), or a G4PhantomParameterisation with
+		// regular navigation ("regular", or "regularSkip" to merge steps through voxels of equal material)
+		const G4String& GetPhantomType() const { return fPhantomType; }
+		G4bool IsNestedPhantom() const { return fPhantomType == "nested"; }
+
+		// scoring grid: the phantom voxels, or the parallel world mesh once /det/mesh/ is used (before /run/initialize)
+		void EnableScoringMesh();
+		const ScoringWorld* GetScoringWorld() const { return fScoringWorld; }
+		void GetScoringGrid(G4int& sx, G4int& sy, G4int& sz) const;
+		G4double GetScoringVoxelVolume() const;
+		const SpectrumBinning& GetSpectrumBinning() const { return fSpectrumBinning; }
+
+		// independent primaries (histories) per event, and the per-history sums of squares of dose and fluence
+		G4int GetHistoriesPerEvent() const { return fHistoriesPerEvent; }
+		G4bool IsHistoryUncertainty() const { return fHistoryUncertainty; }
+		G4bool IsTrackLengthFluence() const { return fTrackLengthFluence; }
+
 
 	private:
 		G4int nx, ny, nz;
@@ -38,11 +93,19 @@ class DetectorConstruction : public G4VUserDetectorConstruction
 		G4double dx, dy, dz;
 		G4double px, py, pz;
 		G4LogicalVolume *lWorld;
+		G4VPhysicalVolume *pVoxel;
+		G4VPhysicalVolume *fWorld;      // world of the last Construct(), deleted on a geometry reload
+		G4LogicalVolume *fPhantomBox;   // root volume of the phantom region
 
 		void ReadPhantom();
+		void ReadPhantomFromMemory();
 		void MapMaterials();
 		void CreateMaterial(G4long, G4int);
 		void CreatePhantom();
+		void DestroyGeometry();
+		void CreateRegularPhantom(G4LogicalVolume* lBox, G4VPhysicalVolume* pBox);
+		void CreateScorers(G4MultiFunctionalDetector* mfd);
+		G4MultiFunctionalDetector* CreateFusedDetector();
 		void SanityCheck();
 
 		G4NistManager* man;
@@ -59,6 +122,35 @@ class DetectorConstruction : public G4VUserDetectorConstruction
 		std::vector<G4Material*> matVec;		//vector of unique materials
 		std::vector<G4int> matMap;		//map voxel number to G4Material vector index (for Geant4 later)
 
+		//Materials are kept across geometry reloads so that matching (matID, density) pairs reuse their physics tables
+		std::map<std::pair<G4int, G4double>, G4Material*> matCache;
+		G4int fConstructCount;
+		PhantomSpec fPhantomSpec;
+		G4bool fMemoryPhantom;
+		G4String fPhantomType;					//see GetPhantomType()
+		std::vector<size_t> fRegularIndices;	//matMap as read by the regular parameterisation
+
+		//Variance reduction
+		ImportanceMap fImportanceMap;	//per-voxel importance for automatic weight windows
+
+		//Scoring
+		RegionOfInterest fRoi;			//optional restriction of the voxel scorers to a compact sub-grid
+		ScoringWorld* fScoringWorld;	//optional scoring mesh in a parallel world (owned by the run manager)
+		G4bool fFusedScoring;			//score all quantities in one callback (FusedDetector) instead of one primitive each (default)
+		G4bool fDirectionalDose;		//also score forward/backward (along z) electron dose
+		G4bool fTrackLengthFluence;		//also score photon and electron fluence with the track-length estimator
+		G4bool fKermaScoring;			//kerma3d channel is attached (set once kerma mode is first enabled)
+		KermaTable fKermaTable;			//mu_tr of all materials; enabled for kerma runs
+		G4int fHistoriesPerEvent;		//primaries generated per event; each is an independent history
+		G4bool fHistoryUncertainty;		//score the per-history sums of squares of dose3d and the fluences (*_sq)
+		SpectrumBinning fSpectrumBinning;	//per-voxel photon spectra (SpectralFluenceSD); disabled when nbins = 0
+
+		//Air gap
+		G4bool fFastForward;			//move primary photons to the phantom entry point
+		G4bool fAirAttenuation;			//weight fast-forwarded photons by their air transmission
+		G4bool fAutoWorld;				//size the world to the phantom and source instead of the fixed 30x30x410 cm
+		G4ThreeVector fSourcePos;		//beam source position (/det/sourcePosition): importance map and automatic world size
+
         friend class DetectorMessenger;
 };
 
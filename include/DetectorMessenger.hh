@@ -31,6 +31,44 @@ class DetectorMessenger: public G4UImessenger
     DetectorConstruction		*Detector;
     G4UIcmdWithAString          *geoCmd;
     G4UIcmdWithoutParameter     *geoshowCmd;
+    G4UIcmdWithAString          *phantomTypeCmd;
+    G4UIcmdWith3VectorAndUnit   *sourceCmd;
+
+    G4UIdirectory               *vrDir;
+    G4UIcmdWithABool            *wwCmd;
+    G4UIcmdWithADouble          *vrMuCmd;
+    G4UIcmdWithADouble          *vrMaxImpCmd;
+    G4UIcmdWithADouble          *vrRatioCmd;
+    G4UIcmdWithAnInteger        *vrMaxSplitCmd;
+
+    G4UIdirectory               *airDir;
+    G4UIcmdWithABool            *ffCmd;
+    G4UIcmdWithABool            *airAttCmd;
+    G4UIcmdWithABool            *autoWorldCmd;
+
+    G4UIdirectory               *roiDir;
+    G4UIcommand                 *roiBoxCmd;
+    G4UIcmdWithAString          *roiMaskCmd;
+    G4UIcmdWithAnInteger        *roiMarginCmd;
+    G4UIcmdWithAString          *roiOutputCmd;
+    G4UIcmdWithoutParameter     *roiClearCmd;
+
+    G4UIdirectory               *meshDir;
+    G4UIcmdWith3VectorAndUnit   *meshOriginCmd;
+    G4UIcmdWith3VectorAndUnit   *meshExtentCmd;
+    G4UIcmdWith3VectorAndUnit   *meshVoxelCmd;
+
+    G4UIdirectory               *scorerDir;
+    G4UIcmdWithABool            *fusedCmd;
+    G4UIcmdWithABool            *directionalCmd;
+    G4UIcmdWithABool            *trackLengthCmd;
+    G4UIcmdWithABool            *kermaCmd;
+    G4UIcmdWithAnInteger        *historiesCmd;
+    G4UIcmdWithABool            *uncertaintyCmd;
+
+    G4UIdirectory               *spectrumDir;
+    G4UIcommand                 *spectrumBinsCmd;
+    G4UIcmdWithADouble          *spectrumMemCmd;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
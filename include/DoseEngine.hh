@@ -0,0 +1,97 @@
+#ifndef DoseEngine_h
+#define DoseEngine_h 1
+
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Timer.hh"
+
+#include "Span.hh"
+#include "DetectorConstruction.hh"
+
+#include <map>
+#include <vector>
+
+class G4RunManager;
+
+// beam for SetSource(): rectangular plane source with a focused angular distribution, as in square_field_gps.mac
+//   (generated by FocusedRectangleSource)
+struct SourceSpec {
+    G4String particle = "gamma";
+    G4double energy = 0;                                  // mono-energetic beam; 0 uses spectrumFile
+    G4String spectrumFile = "spectrum_varian6X.mac";      // /gps/hist/file format (arb, linear interpolation)
+    G4ThreeVector center = G4ThreeVector(0, 0, -110*cm);  // center of the source plane
+    G4double halfx = 5*mm, halfy = 5*mm;                  // half size of the source plane
+    G4ThreeVector focus = G4ThreeVector(0, 0, -100*cm);   // all particles are directed through this point
+};
+
+/* C++ API of the dose engine for embedding it in other applications; the geant4-boilerplate executable is a thin client
+ *   that sets a geometry file and runs macros.
+ * getInstance() creates the run manager (multithreaded if Geant4 is) and registers the detector, physics and actions.
+ * The phantom comes from a geometry file or from in-memory density and material arrays (SetPhantom()). Sources are set
+ *   with SetSource(), which configures and enables the FocusedRectangleSource, or with /rect/ or /gps/ commands through
+ *   Apply() (GPS is used while /rect/enable is false).
+ * With SetMemoryOutput(true) the scored volumes are accumulated into buffers owned by the engine instead of the
+ *   <quantity>.bin files, and GetOutput() returns views of them (ZYX ordering, x fastest, on the scoring grid of
+ *   GetOutputGrid()). Like the files they are cumulative over runs, until ResetOutput().
+ * It also keeps the job bookkeeping shared by the run actions, messengers, JobSpool and Checkpoint (master thread): the
+ *   geometry file, the number of events processed so far and the initialization timing.
+ */
+class DoseEngine
+{
+    public:
+        static DoseEngine* getInstance();
+        static DoseEngine* instance;
+        ~DoseEngine();
+
+        G4RunManager* GetRunManager() const { return fRunManager; }
+
+        // phantom for the next run; after the first run the geometry is rebuilt at the next BeamOn()
+        void SetPhantomFile(const G4String& fname);
+        void SetPhantom(const PhantomSpec& spec);
+
+        void SetSource(const SourceSpec& source);
+        G4int Apply(const G4String& command); // any UI command, e.g. "/run/numberOfThreads 8"
+
+        // initializes on the first call; returns the number of events processed
+        G4long BeamOn(G4long nevents);
+
+        void SetMemoryOutput(G4bool val) { fMemoryOutput = val; }
+        G4bool IsMemoryOutput() const { return fMemoryOutput; }
+        Span<const G4double> GetOutput(const G4String& quantity = "dose3d") const; // empty if not scored
+        void GetOutputGrid(G4int& nx, G4int& ny, G4int& nz) const;
+        void ResetOutput();
+
+        // used by the master RunAction; (re)allocated and zeroed when the grid changes
+        std::vector<G4double>& OutputBuffer(const G4String& name, G4int nx, G4int ny, G4int nz);
+
+        // geometry file of the next Construct()
+        const G4String& GetGeometryFile() const { return fGeoFname; }
+        void SetGeometryFile(const G4String& fname) { fGeoFname = fname; }
+
+        // events processed in all runs so far; updated after each run by the master RunAction (restored by Checkpoint)
+        G4long GetEventsProcessed() const { return fEventsProcessed; }
+        void AddEventsProcessed(G4long n) { fEventsProcessed += n; }
+        void SetEventsProcessed(G4long n) { fEventsProcessed = n; }
+
+        // geometry/material construction through physics table building: started by Construct(), stopped at the first
+        //   master BeginOfRunAction after it; the cold time is that of the first run
+        G4Timer& GetInitTimer() { return fInitTimer; }
+        G4double GetColdInitTime() const { return fColdInitTime; }
+        void SetColdInitTime(G4double seconds) { fColdInitTime = seconds; }
+
+    private:
+        DoseEngine();
+
+        G4RunManager* fRunManager;
+        G4bool fMemoryOutput;
+        std::map<G4String, std::vector<G4double>> fOutputs;
+        G4int fGrid[3];
+
+        G4String fGeoFname;
+        G4long   fEventsProcessed;
+        G4Timer  fInitTimer;
+        G4double fColdInitTime; // [s]
+};
+
+#endif
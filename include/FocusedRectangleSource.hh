@@ -0,0 +1,75 @@
+#ifndef FocusedRectangleSource_h
+#define FocusedRectangleSource_h 1
+
+#include "G4VPrimaryGenerator.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class RectSourceMessenger;
+class G4ParticleDefinition;
+class G4Event;
+
+/* Divergent rectangular field (or beamlet): the specialized equivalent of the GPS setup of square_field_gps.mac
+ *   (/gps/pos/type Plane, /gps/pos/shape Rectangle, /gps/ang/type focused, /gps/ene/type Arb with /gps/hist/inter Lin).
+ * Positions are uniform on the rectangle centre + u*rot1 + v*rot2 (|u| < halfx, |v| < halfy; rot2 is made orthogonal to
+ *   rot1 as in GPS), and every particle is directed through the focus point.
+ * Energies follow the piecewise linear density through the points of the spectrum file, as GPS does for Arb histograms
+ *   with linear interpolation. An alias table over the segments is built once when the spectrum is set, so a sample
+ *   costs one table lookup and the inverse of a linear density on its segment, independent of the number of points.
+ * The source is shared by all threads and configured with the /rect/ commands (or DoseEngine::SetSource()) on the
+ *   master; PrimaryGeneratorAction uses it instead of GPS once it is enabled.
+ */
+class FocusedRectangleSource : public G4VPrimaryGenerator
+{
+    public:
+        static FocusedRectangleSource* getInstance();
+        static FocusedRectangleSource* instance;
+        ~FocusedRectangleSource();
+
+        virtual void GeneratePrimaryVertex(G4Event* anEvent);
+        G4double SampleEnergy() const;
+
+        void SetEnabled(G4bool val) { fEnabled = val; }
+        G4bool IsEnabled() const { return fEnabled; }
+
+        void SetParticle(G4ParticleDefinition* particle) { fParticle = particle; }
+        void SetCentre(const G4ThreeVector& centre)      { fCentre = centre; }
+        void SetHalfX(G4double val)                      { fHalfX = val; }
+        void SetHalfY(G4double val)                      { fHalfY = val; }
+        void SetRot1(const G4ThreeVector& rot1)          { fRot1 = rot1; UpdateAxes(); }
+        void SetRot2(const G4ThreeVector& rot2)          { fRot2 = rot2; UpdateAxes(); }
+        void SetFocusPoint(const G4ThreeVector& focus)   { fFocus = focus; }
+
+        // mono-energetic beam; replaces the spectrum
+        void SetMonoEnergy(G4double ekin);
+        // points (energy, density) of a piecewise linear spectrum, in increasing energy; replaces the mono energy
+        G4bool SetSpectrum(const std::vector<G4double>& energies, const std::vector<G4double>& weights);
+        // two columns per line, energy [MeV] and density, as read by /gps/hist/file
+        G4bool ReadSpectrum(const G4String& fname);
+
+        void Print() const;
+
+    private:
+        FocusedRectangleSource();
+        void UpdateAxes();
+
+        RectSourceMessenger* fMessenger;
+        G4bool   fEnabled;
+
+        G4ParticleDefinition* fParticle;
+        G4ThreeVector fCentre;
+        G4ThreeVector fRot1, fRot2;   // as set
+        G4ThreeVector fAxisX, fAxisY; // orthonormal plane axes
+        G4double fHalfX, fHalfY;
+        G4ThreeVector fFocus;
+
+        G4double fMonoEnergy;          // used when there is no spectrum
+        std::vector<G4double> fEnergy; // spectrum points
+        std::vector<G4double> fUpper;  // [segment] probability of sampling the density rising towards its upper point
+        std::vector<G4double> fAliasProb;
+        std::vector<G4int>    fAlias;
+};
+
+#endif
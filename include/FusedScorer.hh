@@ -0,0 +1,278 @@
+#ifndef FusedScorer_h
+#define FusedScorer_h 1
+
+#include "G4MultiFunctionalDetector.hh"
+#include "G4VPrimitiveScorer.hh"
+#include "G4THitsMap.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4Track.hh"
+#include "G4VTouchable.hh"
+#include "G4Material.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+
+#include "RegionOfInterest.hh"
+#include "KermaTable.hh"
+#include "HistoryTally.hh"
+
+#include <tuple>
+#include <type_traits>
+
+/* Single-callback scoring of several voxel quantities.
+ * FusedDetector replaces the per-primitive loop of G4MultiFunctionalDetector: each step is decoded once (voxel index,
+ *   particle, direction, weight, density) into a ScoreStep, which is then handed to every channel of a compile-time
+ *   list. A channel pairs a quantity with a filter; filters are small structs composed through templates, so they are
+ *   inlined and compare particle definition pointers instead of names.
+ * Each channel writes into a ScoreChannel, a G4VPrimitiveScorer that only owns the per-event hits map of that quantity,
+ *   so Run and RunAction see the usual "mfd/<name>" collections. Channels that are not attached cost one pointer test.
+ * Voxel indices follow G4PSDoseDeposit3D (ZYX ordering of the scoring grid, replica depths 0/1/2 for X/Y/Z), or the
+ *   compact grid of the RegionOfInterest when one is enabled.
+ */
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+// per-step values shared by all channels
+struct ScoreStep {
+    G4Step*                     step;
+    const G4ParticleDefinition* particle;
+    G4ThreeVector               direction; // pre-step momentum direction
+    G4int                       index;     // voxel index in the scoring grid
+    G4double                    weight;    // pre-step weight
+    G4double                    edep;
+};
+
+// output of one quantity: owns the hits map of the current event, never sees steps itself
+class ScoreChannel : public G4VPrimitiveScorer
+{
+    public:
+        ScoreChannel(const G4String& name) : G4VPrimitiveScorer(name), fHCID(-1), fEvtMap(0), fHistories(false), fTally(0) {}
+        virtual ~ScoreChannel() {}
+
+        virtual void Initialize(G4HCofThisEvent* HCE);
+        virtual void clear();
+
+        inline void Add(G4int index, G4double value) {
+            fEvtMap->add(index, value);
+            if (fTally) { fTally->Add(index, value); }
+        }
+
+        // also feed the per-history tally of the current run, in runs that have it enabled (/det/scorer/uncertainty)
+        void SetHistoryTally(G4bool val) { fHistories = val; }
+        G4bool IsHistoryTally() const { return fHistories; }
+
+    protected:
+        virtual G4bool ProcessHits(G4Step*, G4TouchableHistory*) { return false; }
+
+    private:
+        G4int fHCID;
+        G4THitsMap<G4double>* fEvtMap;
+        G4bool fHistories;
+        HistoryTally* fTally;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace ScoreFilter {
+    struct Any {
+        static inline G4bool Accept(const ScoreStep&) { return true; }
+    };
+    struct Gamma {
+        static inline G4bool Accept(const ScoreStep& s) { return s.particle == G4Gamma::Definition(); }
+    };
+    struct Electrons { // e- and e+
+        static inline G4bool Accept(const ScoreStep& s) {
+            return s.particle == G4Electron::Definition() || s.particle == G4Positron::Definition();
+        }
+    };
+    // travelling along +z (Sign = 1) or -z (Sign = -1), the beam axis
+    template <G4int Sign>
+    struct AlongZ {
+        static inline G4bool Accept(const ScoreStep& s) { return Sign*s.direction.z() > 0.; }
+    };
+    template <class A, class B>
+    struct And {
+        static inline G4bool Accept(const ScoreStep& s) { return A::Accept(s) && B::Accept(s); }
+    };
+    template <class A>
+    struct Not {
+        static inline G4bool Accept(const ScoreStep& s) { return !A::Accept(s); }
+    };
+}
+
+namespace ScoreQuantity {
+    // quantities per unit voxel volume; FusedDetector::Attach() sets the inverse volume of the scoring voxels
+    struct PerVolume {
+        G4double invVolume = 0;
+    };
+
+    // dose = edep*weight/(density*voxel volume), as G4PSDoseDeposit
+    struct Dose : PerVolume {
+        inline void Score(const ScoreStep& s, ScoreChannel* out) {
+            if (s.edep == 0.) { return; }
+            G4double density = s.step->GetTrack()->GetStep()->GetPreStepPoint()->GetMaterial()->GetDensity();
+            out->Add(s.index, s.edep*s.weight*invVolume/density);
+        }
+    };
+
+    // weight of the tracks passing through the voxel (entering and leaving through its boundary), with the weight at
+    // entry as the weighted G4PSPassageCellCurrent (default)
+    struct Passage {
+        G4int trackID = -1;
+        G4double weight = 0;
+        inline void Score(const ScoreStep& s, ScoreChannel* out) {
+            G4bool enter = s.step->GetPreStepPoint()->GetStepStatus() == fGeomBoundary;
+            G4bool exit  = s.step->GetPostStepPoint()->GetStepStatus() == fGeomBoundary;
+            G4int  id    = s.step->GetTrack()->GetTrackID();
+            if (enter && exit) {
+                out->Add(s.index, s.weight);
+            } else if (enter) {
+                trackID = id;
+                weight = s.weight;
+            } else if (exit && trackID == id) {
+                trackID = -1;
+                out->Add(s.index, weight);
+            }
+        }
+    };
+
+    // track-length fluence = step length*weight/voxel volume, as G4PSCellFlux but with the volume known up front
+    struct TrackLength : PerVolume {
+        inline void Score(const ScoreStep& s, ScoreChannel* out) {
+            G4double length = s.step->GetStepLength();
+            if (length == 0.) { return; }
+            out->Add(s.index, length*s.weight*invVolume);
+        }
+    };
+
+    // kerma = E*mu_tr/rho*track-length fluence (see KermaTable); scores only while kerma mode is enabled
+    struct Kerma : PerVolume {
+        const KermaTable* table = 0;
+        inline void Score(const ScoreStep& s, ScoreChannel* out) {
+            if (!table->IsEnabled()) { return; }
+            G4double length = s.step->GetStepLength();
+            if (length == 0.) { return; }
+            G4StepPoint* pre = s.step->GetPreStepPoint();
+            G4double ekin = pre->GetKineticEnergy();
+            const G4Material* mat = pre->GetMaterial();
+            out->Add(s.index, length*s.weight*ekin*table->GetMuTr(mat, ekin)*invVolume/mat->GetDensity());
+        }
+    };
+}
+
+template <class Quantity, class Filter>
+struct ScoreChannelOf {
+    Quantity      quantity;
+    ScoreChannel* out = 0;
+    inline void Score(const ScoreStep& s) {
+        if (out && Filter::Accept(s)) { quantity.Score(s, out); }
+    }
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+template <class... Channels>
+class FusedDetector : public G4MultiFunctionalDetector
+{
+    public:
+        FusedDetector(const G4String& name)
+            : G4MultiFunctionalDetector(name), fNx(0), fNy(0), fNz(0), fInvVolume(0), fRoi(0), fFlatIndex(false) {}
+        virtual ~FusedDetector() {}
+
+        // nx, ny, nz: scoring grid; roi may be null or not enabled. Set before attaching channels.
+        // flatIndex: the voxel copy number is the ZYX index (regular phantom) rather than one replica number per axis
+        void SetGrid(G4int nx, G4int ny, G4int nz, G4double voxelVolume, const RegionOfInterest* roi, G4bool flatIndex) {
+            fNx = nx; fNy = ny; fNz = nz;
+            fFlatIndex = flatIndex;
+            fInvVolume = 1./voxelVolume;
+            fRoi = (roi && roi->IsEnabled()) ? roi : 0;
+        }
+
+        // remove and delete all output collections (e.g. before a geometry reload re-attaches them)
+        void DetachAll() {
+            while (GetNumberOfPrimitives() > 0) {
+                G4VPrimitiveScorer* old = GetPrimitive(0);
+                RemovePrimitive(old);
+                delete old;
+            }
+            DetachFrom<0>();
+        }
+
+        // route channel I of the list into a new output collection "<detector>/<name>"
+        template <std::size_t I>
+        ScoreChannel* Attach(const G4String& name) {
+            ScoreChannel* out = new ScoreChannel(name);
+            std::get<I>(fChannels).out = out;
+            SetInvVolume(std::get<I>(fChannels).quantity);
+            RegisterPrimitive(out);
+            return out;
+        }
+
+        // channel I of the list, e.g. to configure its quantity after Attach<I>()
+        template <std::size_t I>
+        typename std::tuple_element<I, std::tuple<Channels...> >::type& GetChannel() { return std::get<I>(fChannels); }
+
+    protected:
+        virtual G4bool ProcessHits(G4Step* aStep, G4TouchableHistory*) {
+            if (aStep->GetStepLength() == 0. && aStep->GetTotalEnergyDeposit() == 0.) { return true; }
+
+            G4StepPoint* pre = aStep->GetPreStepPoint();
+            const G4VTouchable* touch = pre->GetTouchable();
+            G4int ix, iy, iz;
+            if (fFlatIndex) {
+                G4int copyNo = touch->GetReplicaNumber(0);
+                ix = copyNo % fNx;
+                iy = (copyNo / fNx) % fNy;
+                iz = copyNo / (fNx*fNy);
+            } else {
+                ix = touch->GetReplicaNumber(0);
+                iy = touch->GetReplicaNumber(1);
+                iz = touch->GetReplicaNumber(2);
+            }
+
+            ScoreStep s;
+            s.index = fRoi ? fRoi->CompactIndex(ix, iy, iz) : iz*fNy*fNx + iy*fNx + ix;
+            if (s.index < 0) { return true; }
+            s.step      = aStep;
+            s.particle  = aStep->GetTrack()->GetParticleDefinition();
+            s.direction = pre->GetMomentumDirection();
+            s.weight    = pre->GetWeight();
+            s.edep      = aStep->GetTotalEnergyDeposit();
+            ScoreAll<0>(s);
+            return true;
+        }
+
+    private:
+        template <class Q>
+        typename std::enable_if<std::is_base_of<ScoreQuantity::PerVolume, Q>::value>::type SetInvVolume(Q& q) {
+            q.invVolume = fInvVolume;
+        }
+        template <class Q>
+        typename std::enable_if<!std::is_base_of<ScoreQuantity::PerVolume, Q>::value>::type SetInvVolume(Q&) {}
+
+        template <std::size_t I>
+        inline typename std::enable_if<(I < sizeof...(Channels))>::type ScoreAll(const ScoreStep& s) {
+            std::get<I>(fChannels).Score(s);
+            ScoreAll<I+1>(s);
+        }
+        template <std::size_t I>
+        inline typename std::enable_if<(I == sizeof...(Channels))>::type ScoreAll(const ScoreStep&) {}
+
+        template <std::size_t I>
+        typename std::enable_if<(I < sizeof...(Channels))>::type DetachFrom() {
+            std::get<I>(fChannels).out = 0;
+            DetachFrom<I+1>();
+        }
+        template <std::size_t I>
+        typename std::enable_if<(I == sizeof...(Channels))>::type DetachFrom() {}
+
+        G4int fNx, fNy, fNz;
+        G4double fInvVolume;
+        const RegionOfInterest* fRoi;
+        G4bool fFlatIndex;
+        std::tuple<Channels...> fChannels;
+};
+
+#endif
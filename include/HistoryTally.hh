@@ -0,0 +1,60 @@
+#ifndef HistoryTally_h
+#define HistoryTally_h 1
+
+#include "globals.hh"
+
+#include <vector>
+#include <unordered_map>
+
+/* Per-voxel sum of squares of the contributions of individual histories, for the statistical uncertainty of dose3d
+ *   (/det/scorer/uncertainty). A history is one primary particle and all of its descendants, so an event carries
+ *   /det/scorer/historiesPerEvent of them.
+ * History IDs are eventID*historiesPerEvent + index of the primary that started the chain of tracks: EventAction sets
+ *   the event base, and TrackingAction the primary of each track when there are several histories per event.
+ * Contributions of the current history add up in fTemp, which only holds the voxels it touched; when the next history
+ *   scores, the squares of these totals are moved into the sum of squares (history-by-history method). Only fSum2
+ *   spans the scoring grid. This needs each history to be finished before the next one starts, which the last-in
+ *   first-out urgent stack guarantees: all descendants of a primary are followed before the next primary.
+ * Pending totals are folded in by Merge() (worker runs are complete when merged) and by Finish().
+ */
+class HistoryTally
+{
+    public:
+        HistoryTally() {}
+        ~HistoryTally() {}
+
+        // nvoxels of the scoring grid (or the compact region of interest); 0 disables
+        void Configure(G4long nvoxels);
+        G4bool IsEnabled() const { return !fSum2.empty(); }
+
+        inline void Add(G4int index, G4double value) {
+            if (fHistory != sHistory) {
+                Flush();
+                fHistory = sHistory;
+            }
+            fTemp[index] += value;
+        }
+
+        void Merge(const HistoryTally& other);
+        void Finish(); // fold the pending history totals into the sum of squares
+        const std::vector<G4double>& GetSumOfSquares() const { return fSum2; }
+
+        // history of the track being followed on this thread
+        static void BeginEvent(G4int eventID, G4int historiesPerEvent) {
+            sEventBase = (G4long)eventID*historiesPerEvent;
+            sHistory = sEventBase;
+        }
+        static void SetPrimary(G4int primary) { sHistory = sEventBase + primary; }
+
+    private:
+        void Flush();
+
+        std::vector<G4double> fSum2;
+        std::unordered_map<G4int, G4double> fTemp; // totals of the current history by voxel
+        G4long fHistory = -1;
+
+        static G4ThreadLocal G4long sEventBase;
+        static G4ThreadLocal G4long sHistory;
+};
+
+#endif
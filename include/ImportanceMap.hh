@@ -0,0 +1,63 @@
+#ifndef ImportanceMap_h
+#define ImportanceMap_h 1
+
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include <vector>
+
+class G4Step;
+class G4ParticleChange;
+class G4VPhysicalVolume;
+
+/* Per-voxel importance derived from the radiological depth of each voxel as seen from the beam source.
+ * Build() ray-traces the phantom density grid from the source position to every voxel center, and assigns
+ *   importance = exp(mu * d_rad), where d_rad is the water-equivalent depth (cm) and mu is an effective
+ *   attenuation coefficient (1/cm) for the beam. Importance is normalized to 1 at the shallowest voxel and
+ *   clamped to [1, maxImportance].
+ * ApplyWeightWindow() is called by the WeightWindowProcess at the end of every photon step and splits or roulettes
+ *   photons as they cross into a new voxel so that their weight stays inside a window centered at 1/importance.
+ */
+class ImportanceMap
+{
+    public:
+        ImportanceMap();
+        // the source position is set by DetectorConstruction (/det/sourcePosition) before Build()
+        ~ImportanceMap() {}
+
+        // voxel data is in ZYX ordering (x fastest), as stored by DetectorConstruction
+        void Build(G4int nx, G4int ny, G4int nz, G4double dx, G4double dy, G4double dz, const G4ThreeVector& center,
+                const std::vector<G4double>& densVec, const std::vector<G4int>& matMap);
+        void Clear();
+        void ApplyWeightWindow(const G4Step& step, G4ParticleChange& change) const;
+
+        G4bool   IsBuilt() const { return !fImportance.empty(); }
+        G4double GetImportance(G4long idx) const { return fImportance[idx]; }
+        G4double GetRadiologicalDepth(G4long idx) const { return fRadDepth[idx]; }
+
+        void SetEnabled(G4bool val)                      { fEnabled = val; }
+        void SetVoxelVolume(const G4VPhysicalVolume* pv, G4bool flatIndex) { fVoxelVolume = pv; fFlatIndex = flatIndex; }
+        void SetSourcePosition(const G4ThreeVector& pos) { fSourcePos = pos; }
+        void SetAttenuation(G4double mu)                 { fMu = mu; }
+        void SetMaxImportance(G4double val)              { fMaxImportance = val; }
+        void SetWindowRatio(G4double val)                { fWindowRatio = val; }
+        void SetMaxSplit(G4int val)                      { fMaxSplit = val; }
+        G4bool IsEnabled() const { return fEnabled; }
+
+    private:
+        G4bool        fEnabled;
+        G4ThreeVector fSourcePos;     // position of the (virtual) beam source
+        G4double      fMu;            // effective attenuation coefficient [1/cm of water]
+        G4double      fMaxImportance; // upper bound on importance (limits splitting depth)
+        G4double      fWindowRatio;   // ratio of upper to lower weight window bound
+        G4int         fMaxSplit;      // maximum number of copies produced by a single split
+
+        const G4VPhysicalVolume* fVoxelVolume; // parameterised voxel volume of the phantom
+        G4bool                   fFlatIndex;   // its copy number is the ZYX index (regular phantom)
+
+        G4int    fNx, fNy, fNz;
+
+        std::vector<G4float> fRadDepth;   // water-equivalent depth [cm]
+        std::vector<G4float> fImportance;
+};
+
+#endif
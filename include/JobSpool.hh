@@ -0,0 +1,57 @@
+#ifndef JobSpool_h
+#define JobSpool_h 1
+
+#include "globals.hh"
+
+#include <vector>
+
+class SpoolMessenger;
+
+/* Service mode: run many small jobs in one process so that materials, physics tables and threads are set up once.
+ * Watch() polls a spool directory for job descriptions "<name>.job" and runs them back to back, oldest first. A job is
+ *   claimed by renaming it to "<name>.running" (so several daemons may share a spool) and ends up as "<name>.done" or
+ *   "<name>.failed". Each job file holds "key value" lines; relative paths are taken from the spool directory:
+ *     macro    <file>   macro with the job's /run/beamOn commands (required)
+ *     geometry <file>   phantom to load with /det/geo if different from the current one (optional)
+ *     output   <dir>    directory receiving all output files of the job (default: <spool>/<name>)
+ * Per job, the queue wait, setup (geometry reload) time, initialization time saved relative to the first cold start,
+ *   wall time and throughput are printed and appended to "<spool>/jobs.csv".
+ * Watching stops when a file named "stop" appears in the spool, or after <idleTimeout> seconds without jobs (if > 0).
+ */
+class JobSpool
+{
+    public:
+        static JobSpool* getInstance();
+        static JobSpool* instance;
+        ~JobSpool();
+
+        void SetPollInterval(G4double seconds) { fPollInterval = seconds; }
+        void SetIdleTimeout(G4double seconds)  { fIdleTimeout = seconds; }
+
+        void Watch(const G4String& spoolDir);
+
+    private:
+        JobSpool();
+
+        struct Job {
+            G4String name;
+            G4String macro, geometry, output;
+            G4double submitted; // job file mtime [s since epoch]
+        };
+
+        std::vector<Job> ListJobs(const G4String& spoolDir) const;
+        G4bool ReadJob(const G4String& spoolDir, Job& job) const;
+        G4bool RunJob(const G4String& spoolDir, const Job& job);
+
+        SpoolMessenger* fMessenger;
+        G4double fPollInterval; // [s]
+        G4double fIdleTimeout;  // [s]; 0 waits forever
+
+        // totals over the current Watch()
+        G4int    fJobs;
+        G4long   fEvents;
+        G4double fWallTime;
+        G4double fInitSaved;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef KermaTable_h
+#define KermaTable_h 1
+
+#include "globals.hh"
+#include "G4Material.hh"
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+/* Linear energy-transfer coefficients mu_tr(E) of every material, for (total) kerma scoring of photons.
+ * Build() tabulates, after the physics tables are built, mu_tr = sum_p mu_p(E)*f_p(E) on a log energy grid from the
+ *   cross sections of the physics list (G4EmCalculator), with the fraction f_p of the photon energy given to electrons:
+ *   1 for the photoelectric effect, the Klein-Nishina mean for Compton scattering, (E - 2 m_e c^2)/E for pair production
+ *   and 0 for Rayleigh scattering; fluorescence is neglected.
+ * No radiative yield (g-factor) is applied, so this is not mu_en: kerma3d is total kerma, which exceeds collision kerma
+ *   (and dose under electronic equilibrium) by g/(1-g), below 1% for tissue in MV photon beams.
+ * Tables are indexed by G4Material::GetIndex(), so they cover all phantom materials (mat<ID>_<den>) without a lookup.
+ * With kerma scoring enabled, kerma = E*mu_tr/rho*fluence is scored from photon track lengths (kerma3d) and
+ *   secondary electrons are killed (StackingAction); this approximates dose away from interfaces and the buildup region.
+ */
+class KermaTable
+{
+    public:
+        KermaTable();
+        ~KermaTable() {}
+
+        void Build();
+        void Clear() { fMuTr.clear(); }
+        G4bool IsBuilt() const { return !fMuTr.empty(); }
+
+        void SetEnabled(G4bool val) { fEnabled = val; }
+        G4bool IsEnabled() const { return fEnabled; }
+
+        // mu_tr [1/length] of the material at photon energy ekin; linear interpolation in ln(E)
+        inline G4double GetMuTr(const G4Material* mat, G4double ekin) const {
+            const std::vector<G4double>& table = fMuTr[mat->GetIndex()];
+            G4double x = (std::log(ekin) - fLnEmin)*fInvDlnE;
+            G4int b = std::min(fNbins-2, std::max(0, (G4int)x));
+            G4double f = std::min(1., std::max(0., x - b));
+            return table[b] + f*(table[b+1] - table[b]);
+        }
+
+    private:
+        static G4double ComptonEnergyFraction(G4double ekin);
+
+        G4bool   fEnabled;
+        G4int    fNbins;
+        G4double fEmin, fEmax, fLnEmin, fInvDlnE;
+        std::vector<std::vector<G4double>> fMuTr; // [material index][bin]
+};
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef NavigationStats_h
+#define NavigationStats_h 1
+
+#include "globals.hh"
+
+/* Tracks and voxel material lookups of a run, to compare the phantom geometry representations (/det/phantomType).
+ * ComputeMaterial() of the phantom parameterisations counts its calls per thread; Run::RecordEvent() moves the count
+ *   into the run after every event. SteppingAction counts the tracks.
+ */
+struct NavigationStats {
+    G4long tracks = 0;
+    G4long computeMaterialCalls = 0;
+
+    void Merge(const NavigationStats& other) {
+        tracks += other.tracks;
+        computeMaterialCalls += other.computeMaterialCalls;
+    }
+
+    static inline void CountComputeMaterial() { ++sComputeMaterialCalls; }
+    static inline G4long TakeComputeMaterialCalls() {
+        G4long n = sComputeMaterialCalls;
+        sComputeMaterialCalls = 0;
+        return n;
+    }
+
+    private:
+        static G4ThreadLocal G4long sComputeMaterialCalls;
+};
+
+#endif
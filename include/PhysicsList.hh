@@ -4,6 +4,18 @@
 #include "G4VModularPhysicsList.hh"
 #include "globals.hh"
 
+#include <map>
+
+class PhysicsListMessenger;
+class G4VPhysicsConstructor;
+
+// production cut and step limits for a named G4Region; negative values are left at the Geant4 defaults
+struct RegionSettings {
+  G4double cut      = -1.;
+  G4double maxStep  = -1.;
+  G4double minEkine = -1.;
+};
+
 // G4VModularPhysicsList inherits from G4VUserPhysicsList and allows construction with pre-built physics "modules"
 class PhysicsList: public G4VModularPhysicsList
 {
@@ -12,6 +24,49 @@ public:
   virtual ~PhysicsList();
 
   virtual void SetCuts();
+
+  // physics profiles, selected before /run/initialize:
+  //   reference:   decay + radioactive decay + EM
+  //   lean-photon: EM only (for MV photon beams)
+  void SetProfile(const G4String& profile);
+  void SetEmPhysics(const G4String& name);
+  const G4String& GetProfile() const { return fProfile; }
+  const G4String& GetEmName() const { return fEmName; }
+
+  // physics-table cache: tables are stored under <dir>/<key>/, where the key hashes the Geant4 and data set versions,
+  //   material composition and density, production cuts and physics profile; a later process with the same key
+  //   retrieves instead of building
+  void SetTableCache(const G4String& dir) { fCacheDir = dir; }
+  void StoreTableCache();
+  const G4String& GetTableCacheState() const { return fCacheState; }
+
+  // Woodcock tracking of photons in the phantom region (registers fast simulation for gamma; see WoodcockModel)
+  void SetWoodcock(G4bool enable);
+  G4bool IsWoodcockEnabled() const { return fWoodcock; }
+
+  // transport in a parallel world (e.g. the scoring mesh) registered with the detector construction
+  void AddParallelWorld(const G4String& worldName);
+
+  // region names are those of the G4RegionStore; "world" is an alias for the default world region
+  void SetRegionCut(const G4String& region, G4double cut);
+  void SetRegionMaxStep(const G4String& region, G4double step);
+  void SetRegionMinEkine(const G4String& region, G4double ekin);
+  void ApplyRegionSettings();
+  void ListRegions() const;
+
+private:
+  void PrepareTableCache();
+
+  PhysicsListMessenger* fMessenger;
+  G4String fProfile;
+  G4String fEmName;
+  G4VPhysicsConstructor* fDecayPhysics;
+  G4VPhysicsConstructor* fRadDecayPhysics;
+  G4bool fWoodcock;
+  G4String fCacheDir;
+  G4String fCacheKey;
+  G4String fCacheState; // "off", "cold" or "warm"
+  std::map<G4String, RegionSettings> fRegionSettings;
 };
 
 #endif
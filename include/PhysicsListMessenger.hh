@@ -0,0 +1,42 @@
+#ifndef PhysicsListMessenger_h
+#define PhysicsListMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class PhysicsList;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithAString;
+class G4UIcmdWithABool;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+class PhysicsListMessenger: public G4UImessenger
+{
+  public:
+
+    PhysicsListMessenger(PhysicsList* );
+   ~PhysicsListMessenger();
+
+    void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+    G4UIcommand* NewRegionCommand(const char* path, const char* guidance, const char* defaultUnit);
+
+	G4UIdirectory				*Dir;
+	G4UIdirectory				*regionDir;
+    PhysicsList					*fPhysicsList;
+    G4UIcmdWithAString          *profileCmd;
+    G4UIcmdWithAString          *emCmd;
+    G4UIcmdWithAString          *tableCacheCmd;
+    G4UIcmdWithABool            *woodcockCmd;
+    G4UIcommand                 *regionCutCmd;
+    G4UIcommand                 *regionStepCmd;
+    G4UIcommand                 *regionEkinCmd;
+    G4UIcmdWithoutParameter     *regionListCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -20,6 +20,8 @@ class G4Event;
 class G4ParticleGun;
 class G4ParticleTable;
 class G4PrimaryParticle;
+class G4EmCalculator;
+class DetectorConstruction;
 
 //Custom data container for particle phasespace values
 struct pspinfo
@@ -67,9 +69,20 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
    ~PrimaryGeneratorAction();
 
     virtual void GeneratePrimaries(G4Event*);
+
+    // position in the phase-space files (for checkpoints); empty when generating from GPS
+    G4String GetSourceState();
+    void SetSourceState(const G4String& state);
   private:
     void init();
     void generate(G4Event*);
+    void FastForward(G4Event*);
+    G4double GetAirMu(G4double ekin);
+
+    const DetectorConstruction* fDetector;
+    G4EmCalculator* fEmCalculator;
+    std::vector<G4double> fAirMu; // attenuation coefficient of the world material on a log energy grid
+    G4int fAirMuRun;              // run the table was built for
 
 #ifdef USEPHASESPACE
     G4ParticleGun* fParticleGun;
@@ -80,6 +93,10 @@ class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
     std::list<pspinfo> pList;
     psfvectlist psfvects;
     int default_batchSize = 10000;
+    int psf_lineSize = 21; // must match sum of included data length [bytes]
+    std::string fBatchFile; // file and offset of the batch in pList
+    G4int fBatchStart;
+    G4int fBatchSize;
 #else
     G4GeneralParticleSource* fParticleGun;
 #endif
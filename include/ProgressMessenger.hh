@@ -0,0 +1,31 @@
+#ifndef ProgressMessenger_h
+#define ProgressMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class ProgressReporter;
+class G4UIdirectory;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAString;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+class ProgressMessenger: public G4UImessenger
+{
+  public:
+
+    ProgressMessenger(ProgressReporter* );
+   ~ProgressMessenger();
+
+    void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+	G4UIdirectory				*Dir;
+    ProgressReporter			*fReporter;
+    G4UIcmdWithADoubleAndUnit   *intervalCmd;
+    G4UIcmdWithAString          *statusFileCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
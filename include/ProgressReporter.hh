@@ -0,0 +1,80 @@
+#ifndef ProgressReporter_h
+#define ProgressReporter_h 1
+
+#include "globals.hh"
+
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+class ProgressMessenger;
+
+/* Periodic progress report for long runs.
+ * Workers call EventDone() at the end of each event, which bumps the (cache-line padded) counter of that worker with a
+ *   relaxed atomic increment. Start() and Stop() are called by the master RunAction and run a reporter thread that
+ *   wakes up every <interval> seconds to print events/sec, the per-thread balance and the ETA, and optionally writes
+ *   the same information to a status file (written to a temporary file and renamed, so readers never see partial
+ *   content).
+ * Reporting is disabled while the interval is 0.
+ * Independently of reporting, the end time of the last event of each worker is kept so that Stop() can print the tail
+ *   idle time of the run: how long workers sat idle between finishing their last event and the end of the run.
+ */
+class ProgressReporter
+{
+    public:
+        static ProgressReporter* getInstance();
+        static ProgressReporter* instance;
+        ~ProgressReporter();
+
+        void SetInterval(G4double seconds)   { fInterval = seconds; }
+        void SetStatusFile(const G4String& fname) { fStatusFile = fname; }
+
+        void Start(G4int runID, G4long eventsToProcess, G4int nThreads);
+        void Stop();
+
+        inline void EventDone(G4int threadID) {
+            Slot& slot = fSlots[(threadID < 0 ? 0 : threadID) % kMaxSlots];
+            slot.events.fetch_add(1, std::memory_order_relaxed);
+            slot.lastEvent.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+
+        // tail idle time of the last run, as fraction of the total worker time
+        G4double GetTailIdleFraction() const { return fTailIdle; }
+
+    private:
+        ProgressReporter();
+        void Loop();
+        void Report(G4bool final);
+        void ReportTailIdle();
+
+        static const G4int kMaxSlots = 256;
+        // aligned (and so padded) to a cache line so that counters of different workers are never on the same line;
+        // static, because operator new of C++11 does not honour the alignment of over-aligned types
+        struct alignas(64) Slot {
+            std::atomic<G4long> events{0};
+            std::atomic<std::chrono::steady_clock::rep> lastEvent{0};
+        };
+        static_assert(sizeof(Slot) == 64, "one cache line per slot");
+        static Slot fSlots[kMaxSlots];
+
+        ProgressMessenger* fMessenger;
+        G4double fInterval;   // [s]; 0 disables reporting
+        G4String fStatusFile; // empty: no status file
+
+        G4int  fRunID;
+        G4long fEventsToProcess;
+        G4int  fNThreads;
+        std::chrono::steady_clock::time_point fStartTime;
+        std::chrono::steady_clock::time_point fLastTime;
+        G4long fLastEvents;
+        G4double fTailIdle;
+
+        std::thread fThread;
+        std::mutex fMutex;
+        std::condition_variable fWakeup;
+        G4bool fStopping; // also true while no run is active
+};
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef RectSourceMessenger_h
+#define RectSourceMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class FocusedRectangleSource;
+class G4UIdirectory;
+class G4UIcmdWithABool;
+class G4UIcmdWithAString;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWith3Vector;
+class G4UIcmdWith3VectorAndUnit;
+class G4UIcmdWithoutParameter;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+class RectSourceMessenger: public G4UImessenger
+{
+  public:
+
+    RectSourceMessenger(FocusedRectangleSource* );
+   ~RectSourceMessenger();
+
+    void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+	G4UIdirectory				*Dir;
+    FocusedRectangleSource		*fSource;
+    G4UIcmdWithABool            *enableCmd;
+    G4UIcmdWithAString          *particleCmd;
+    G4UIcmdWithoutParameter     *listCmd;
+
+    G4UIdirectory               *posDir;
+    G4UIcmdWith3VectorAndUnit   *centreCmd;
+    G4UIcmdWithADoubleAndUnit   *halfxCmd;
+    G4UIcmdWithADoubleAndUnit   *halfyCmd;
+    G4UIcmdWith3Vector          *rot1Cmd;
+    G4UIcmdWith3Vector          *rot2Cmd;
+
+    G4UIdirectory               *angDir;
+    G4UIcmdWith3VectorAndUnit   *focusCmd;
+
+    G4UIdirectory               *eneDir;
+    G4UIcmdWithADoubleAndUnit   *monoCmd;
+
+    G4UIdirectory               *histDir;
+    G4UIcmdWithAString          *histFileCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
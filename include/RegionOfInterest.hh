@@ -0,0 +1,62 @@
+#ifndef RegionOfInterest_h
+#define RegionOfInterest_h 1
+
+#include "globals.hh"
+#include <vector>
+
+/* Restricts scoring to part of the phantom, given either as a voxel index bounding box or as a mask file.
+ * Build() turns the request into a compact scoring grid: the (clamped) bounding box, or the bounding box of the mask,
+ *   grown by <margin> voxels on each side. For a mask, the margin also dilates the mask itself, and voxels of the
+ *   compact grid outside the dilated mask are not scored.
+ * The mask file holds one byte per voxel of the full phantom in ZYX ordering (x fastest), nonzero inside the ROI.
+ * CompactIndex() maps full-grid voxel indices to an index into the compact grid, or -1 outside the ROI.
+ */
+class RegionOfInterest
+{
+    public:
+        RegionOfInterest();
+        ~RegionOfInterest() {}
+
+        // requested ROI; takes effect at the next Build()
+        void SetBox(G4int ix0, G4int iy0, G4int iz0, G4int ix1, G4int iy1, G4int iz1);
+        void SetMaskFile(const G4String& fname);
+        void SetMargin(G4int voxels)      { fMargin = voxels; }
+        void SetExpandedOutput(G4bool val) { fExpanded = val; }
+        void Clear();
+
+        void Build(G4int nx, G4int ny, G4int nz);
+
+        G4bool IsRequested() const      { return fMode != kNone; }
+        G4bool IsEnabled() const        { return fBuilt; }
+        G4bool IsExpandedOutput() const { return fExpanded; }
+
+        // compact grid size and position of its first voxel in the full grid
+        G4int GetNx() const { return fN[0]; }
+        G4int GetNy() const { return fN[1]; }
+        G4int GetNz() const { return fN[2]; }
+        G4int GetOffsetX() const { return fLo[0]; }
+        G4int GetOffsetY() const { return fLo[1]; }
+        G4int GetOffsetZ() const { return fLo[2]; }
+
+        inline G4int CompactIndex(G4int ix, G4int iy, G4int iz) const {
+            ix -= fLo[0]; iy -= fLo[1]; iz -= fLo[2];
+            if (ix < 0 || iy < 0 || iz < 0 || ix >= fN[0] || iy >= fN[1] || iz >= fN[2]) { return -1; }
+            G4int idx = iz*fN[1]*fN[0] + iy*fN[0] + ix; // ZYX ordering
+            return (fMask.empty() || fMask[idx]) ? idx : -1;
+        }
+
+    private:
+        enum Mode { kNone, kBox, kMask };
+        Mode     fMode;
+        G4int    fBoxLo[3], fBoxHi[3]; // requested box (inclusive voxel indices)
+        G4String fMaskFile;
+        G4int    fMargin;
+        G4bool   fExpanded;
+
+        // compact grid (valid once built)
+        G4bool fBuilt;
+        G4int  fLo[3], fN[3];
+        std::vector<char> fMask; // per compact voxel; empty for a box
+};
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef RegularParam_h
+#define RegularParam_h 1
+
+#include "G4PhantomParameterisation.hh"
+
+class G4VPhysicalVolume;
+class G4VTouchable;
+class G4Material;
+
+/* Phantom as a single parameterised volume with regular navigation (/det/phantomType regular or regularSkip), the
+ *   alternative to the nested replicas of NestedParam. Copy numbers are the voxel index in ZYX ordering (x fastest).
+ * Only counts the material lookups; everything else is G4PhantomParameterisation.
+ */
+class RegularParam : public G4PhantomParameterisation
+{
+  public:
+    RegularParam() : G4PhantomParameterisation() {}
+    virtual ~RegularParam() {}
+
+    G4Material* ComputeMaterial(const G4int copyNo, G4VPhysicalVolume* currentVol, const G4VTouchable* parentTouch=0);
+};
+
+#endif
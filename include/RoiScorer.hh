@@ -0,0 +1,57 @@
+#ifndef RoiScorer_h
+#define RoiScorer_h 1
+
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4VTouchable.hh"
+
+#include "RegionOfInterest.hh"
+
+/* Restricts a 3D voxel scorer (G4PSDoseDeposit3D, G4PSPassageCellCurrent3D, ...) to a RegionOfInterest.
+ * Hits outside the ROI are dropped before the wrapped scorer sees them, and hits inside are keyed by their index in the
+ *   compact ROI grid, so hits maps, merging and output scale with the ROI instead of the full phantom.
+ * The copy numbers of the X, Y and Z replicas are at touchable depth 0, 1 and 2 respectively; with flatIndex (regular
+ *   phantom) the copy number of the voxel itself is its ZYX index instead. Without an enabled ROI, hits are keyed by
+ *   their index in the full grid, which is only needed for the flat index.
+ */
+template <class T>
+class RoiScorer : public T
+{
+    public:
+        // nx, ny, nz: full scoring grid; roi may be null or not enabled
+        RoiScorer(const G4String& name, G4int nx, G4int ny, G4int nz, const RegionOfInterest* roi, G4bool flatIndex)
+            : T(name, Enabled(roi) ? roi->GetNz() : nz, Enabled(roi) ? roi->GetNy() : ny, Enabled(roi) ? roi->GetNx() : nx),
+            fNx(nx), fNy(ny), fRoi(Enabled(roi) ? roi : 0), fFlatIndex(flatIndex) {}
+        virtual ~RoiScorer() {}
+
+    protected:
+        virtual G4bool ProcessHits(G4Step* aStep, G4TouchableHistory* history) {
+            if (GetIndex(aStep) < 0) { return false; }
+            return T::ProcessHits(aStep, history);
+        }
+
+        virtual G4int GetIndex(G4Step* aStep) {
+            const G4VTouchable* touch = aStep->GetPreStepPoint()->GetTouchable();
+            G4int ix, iy, iz;
+            if (fFlatIndex) {
+                G4int copyNo = touch->GetReplicaNumber(0);
+                ix = copyNo % fNx;
+                iy = (copyNo / fNx) % fNy;
+                iz = copyNo / (fNx*fNy);
+            } else {
+                ix = touch->GetReplicaNumber(0);
+                iy = touch->GetReplicaNumber(1);
+                iz = touch->GetReplicaNumber(2);
+            }
+            return fRoi ? fRoi->CompactIndex(ix, iy, iz) : iz*fNy*fNx + iy*fNx + ix;
+        }
+
+    private:
+        static G4bool Enabled(const RegionOfInterest* roi) { return roi && roi->IsEnabled(); }
+
+        G4int fNx, fNy;
+        const RegionOfInterest* fRoi;
+        G4bool fFlatIndex;
+};
+
+#endif
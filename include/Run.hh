@@ -2,6 +2,7 @@
 #define RUN_HH
 
 #include <map>
+#include <vector>
 
 #include "G4THitsMap.hh"
 #include "G4Run.hh"
@@ -9,8 +10,14 @@
 #include "G4ThreeVector.hh"
 #include "G4SystemOfUnits.hh"
 
+#include "StepProfiler.hh"
+#include "SparseSpectra.hh"
+#include "HistoryTally.hh"
+#include "NavigationStats.hh"
+
 class G4Event;
 class G4MultiFunctionalDetector;
+class G4Region;
 
 struct iTwoVector {
     int x, y;
@@ -26,6 +33,12 @@ typedef std::map<G4String, t_hitsmap*> t_hitscoll;
 typedef std::map<iTwoVector, t_hitscoll> t_beamlet_colls;
 typedef t_hitscoll::const_iterator string_map_iter;
 
+struct RegionStats {
+    G4long steps = 0;
+    G4long secondaries = 0;
+};
+typedef std::vector<RegionStats> t_region_stats; // indexed by G4Region::GetInstanceID()
+
 /* User custom Run class that is created by each threadworker after a global run of the same type is started by the G4MTRunManager
  * The RecordEvent() function is performed by each threadworker after each event is concluded - is responsible for processing/saving
  *   any results that have been collected by sensitive volumes into sensitive detector specific "G4THitsMap" containers
@@ -47,6 +60,22 @@ class Run : public G4Run
         // single beamlets
         t_beamlet_colls tracked_beamlets;
 
+        // steps and secondaries per region (filled by SteppingAction)
+        t_region_stats region_stats;
+
+        // tracks and phantom material lookups (filled by SteppingAction and RecordEvent)
+        NavigationStats navigation;
+
+        // steps, tracks and wall time per particle/process/volume (filled only when built with WITH_PROFILING)
+        StepProfiler profiler;
+
+        // per-voxel photon energy spectra (filled by SpectralFluenceSD when /det/spectrum/bins is set)
+        SparseSpectra spectra;
+
+        // per-history sums of squares by scorer name, for the channels that keep them (dose3d and photonFluence) when
+        // /det/scorer/uncertainty is set; filled through their ScoreChannel
+        std::map<G4String, HistoryTally> history_tallies;
+
     protected:
         G4String mfd_name = "mfd";
         double alpha = 10; // focused GPS magnification factor (DfF/Dsf)
@@ -4,9 +4,13 @@
 
 #include "G4UserRunAction.hh"
 #include "G4String.hh"
+#include "G4Timer.hh"
 
 #include "Run.hh"
 
+class PrimaryGeneratorAction;
+class TrackingAction;
+
 struct iThreeVector {
     int x, y, z;
     int size() { return x*y*z; }
@@ -21,13 +25,28 @@ class RunAction : public G4UserRunAction
         virtual void BeginOfRunAction(const G4Run *run);
         virtual void EndOfRunAction(const G4Run *run);
         virtual Run* GenerateRun();
+        Run* GetRun() const { return fRun; }
 
     protected:
         void UpdateOutput(const G4MultiFunctionalDetector* mfd, const std::map<G4String, G4THitsMap<G4double>*>&, G4String fsuffix="");
+        void UpdateOutputFile(const G4String& name, const G4THitsMap<G4double>& hits); // <name>.bin, or engine buffer
+        void UpdateUncertainty(Run* run, G4long histories);
+        void PrintRegionStats(const Run* run) const;
+        void PrintNavigationStats(const Run* run) const;
+        void WriteRoiInfo();
+        void WriteMeshInfo() const;
+        void UpdateSpectra(Run* run) const;
+        PrimaryGeneratorAction* GetGenerator() const; // of this thread
+        void UpdateTrackingAction(); // register the tracking action of this thread for the next run only if needed
 
     private:
         G4String mfd_name = "mfd";
         G4int fRTally = 0;
-        iThreeVector det_size{-1,-1,-1}; // read from file on construction
+        G4int fConstructCount = 0; // geometry build seen by the previous run
+        Run* fRun = nullptr; // current run of this thread
+        TrackingAction* fTrackingAction = nullptr; // registered with the run manager of this thread, or none
+        G4bool fOverwriteOutputs = false; // previous outputs belong to another region of interest
+        G4Timer fRunTimer;
+        iThreeVector det_size{-1,-1,-1}; // phantom dimensions, updated at the start of each run
 };
 #endif
@@ -0,0 +1,48 @@
+#ifndef ScoringWorld_h
+#define ScoringWorld_h 1
+
+#include "G4VUserParallelWorld.hh"
+#include "G4ThreeVector.hh"
+#include "globals.hh"
+
+/* Dose scoring mesh in a parallel world, independent of the CT (transport) grid.
+ * The mesh is a box of voxels given by its lower corner, extent and voxel size; origin and extent default to the
+ *   phantom box. The voxel size is adjusted so that a whole number of voxels covers the extent.
+ * Construct() builds the same nested replica structure as the phantom (Z, then Y, then X replicas; voxel logical
+ *   volume "lMeshX"), so that the 3D primitive scorers and RegionOfInterest index it in the same ZYX order.
+ * Scorers sit on the mesh and see the mass-world material of each step, so the dose of a mesh voxel that spans
+ *   several CT materials is the volume average of edep/(rho*V) over its steps, as for the Geant4 command-based
+ *   scoring meshes.
+ */
+class ScoringWorld : public G4VUserParallelWorld
+{
+    public:
+        ScoringWorld(const G4String& name);
+        virtual ~ScoringWorld() {}
+
+        virtual void Construct();
+
+        void SetOrigin(const G4ThreeVector& lowerCorner) { fOrigin = lowerCorner; fHasOrigin = true; }
+        void SetExtent(const G4ThreeVector& extent)      { fExtent = extent; fHasExtent = true; }
+        void SetVoxelSize(const G4ThreeVector& size)     { fVoxelSize = size; }
+
+        // resolves defaults from the phantom bounds and the number of voxels; called before Construct()
+        void SetupGrid(const G4ThreeVector& phantomLo, const G4ThreeVector& phantomHi);
+
+        G4int GetNx() const { return fN[0]; }
+        G4int GetNy() const { return fN[1]; }
+        G4int GetNz() const { return fN[2]; }
+        const G4ThreeVector& GetOrigin() const { return fGridOrigin; }
+        const G4ThreeVector& GetVoxelSize() const { return fGridVoxel; }
+
+    private:
+        // requested
+        G4ThreeVector fOrigin, fExtent, fVoxelSize;
+        G4bool fHasOrigin, fHasExtent;
+
+        // resolved grid
+        G4int fN[3];
+        G4ThreeVector fGridOrigin, fGridVoxel;
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef SourceVertexInfo_h
+#define SourceVertexInfo_h 1
+
+#include "G4VUserPrimaryVertexInformation.hh"
+#include "G4ThreeVector.hh"
+#include "G4ios.hh"
+
+/* Position a primary vertex had at the source, kept when the vertex is moved to the phantom surface
+ *   (/det/air/fastForward) so that the originating beamlet can still be found from it (Run::GetBeamletNumber).
+ * Owned by the vertex.
+ */
+class SourceVertexInfo : public G4VUserPrimaryVertexInformation
+{
+    public:
+        SourceVertexInfo(const G4ThreeVector& pos) : fPosition(pos) {}
+        virtual ~SourceVertexInfo() {}
+
+        const G4ThreeVector& GetSourcePosition() const { return fPosition; }
+        virtual void Print() const { G4cout << "Source position: " << fPosition << G4endl; }
+
+    private:
+        G4ThreeVector fPosition;
+};
+
+#endif
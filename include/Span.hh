@@ -0,0 +1,35 @@
+#ifndef Span_h
+#define Span_h 1
+
+#include <cstddef>
+#include <vector>
+
+#include "G4Types.hh"
+
+/* Non-owning view of a contiguous array (a minimal std::span for C++11), used to pass phantom data into the library
+ *   and dose buffers out of it without copying.
+ */
+template <typename T>
+class Span
+{
+    public:
+        Span() : fData(0), fSize(0) {}
+        Span(T* data, std::size_t size) : fData(data), fSize(size) {}
+        template <typename U>
+        Span(const std::vector<U>& v) : fData(v.data()), fSize(v.size()) {}
+        template <typename U>
+        Span(std::vector<U>& v) : fData(v.data()), fSize(v.size()) {}
+
+        T* data() const           { return fData; }
+        std::size_t size() const  { return fSize; }
+        G4bool empty() const      { return fSize == 0; }
+        T& operator[](std::size_t i) const { return fData[i]; }
+        T* begin() const          { return fData; }
+        T* end() const            { return fData + fSize; }
+
+    private:
+        T* fData;
+        std::size_t fSize;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef SparseSpectra_h
+#define SparseSpectra_h 1
+
+#include "globals.hh"
+
+#include <vector>
+#include <memory>
+#include <unordered_map>
+#include <cmath>
+#include <cstdint>
+
+// energy binning of the per-voxel spectra; nbins = 0 disables spectral scoring
+struct SpectrumBinning {
+    G4int    nbins = 0;
+    G4double emin = 0;
+    G4double emax = 0;
+    G4bool   log = false;
+    G4double maxMemoryMB = 512; // per Run object (i.e. per thread, and for the merged master run)
+};
+
+/* Energy histograms for the voxels that are actually hit.
+ * A histogram (nbins doubles) is allocated the first time a voxel is filled. Histograms live in fixed-size chunks of
+ *   kChunk histograms, so the storage grows without reallocating or copying, and a hash map takes voxel indices to
+ *   histogram slots. Once maxMemoryMB would be exceeded, hits in voxels without a histogram are counted as dropped
+ *   (and reported) instead of allocating more.
+ * Write() stores the compact form: <prefix>_index.bin (int32 voxel indices, ascending), <prefix>.bin (nbins doubles per
+ *   listed voxel, same order) and <prefix>.txt (binning, grid and counts). Read() adds such files into this object if
+ *   their binning and grid match, and returns false otherwise.
+ */
+class SparseSpectra
+{
+    public:
+        SparseSpectra() : fSlotsPerChunk(0), fMaxSlots(0), fDropped(0), fUnderflow(0), fOverflow(0) {}
+        ~SparseSpectra() {}
+
+        void Configure(const SpectrumBinning& binning);
+        G4bool IsEnabled() const { return fBinning.nbins > 0; }
+        const SpectrumBinning& GetBinning() const { return fBinning; }
+
+        inline void Fill(G4int voxel, G4double ekin, G4double weight) {
+            G4int bin = Bin(ekin);
+            if (bin < 0)               { fUnderflow += weight; return; }
+            if (bin >= fBinning.nbins) { fOverflow += weight; return; }
+            G4double* hist = Histogram(voxel, true);
+            if (!hist) { fDropped += weight; return; }
+            hist[bin] += weight;
+        }
+
+        void Merge(const SparseSpectra& other);
+        // grid: free-form description of the voxel grid the indices refer to (e.g. "100 100 80")
+        G4bool Read(const G4String& prefix, const G4String& grid);
+        void Write(const G4String& prefix, const G4String& grid) const;
+        void Print(const G4String& name) const;
+
+        G4long   GetVoxelCount() const { return (G4long)fSlots.size(); }
+        G4double GetMemoryMB() const;
+
+    private:
+        static const G4int kChunk = 1024;
+
+        inline G4int Bin(G4double ekin) const {
+            G4double x = fBinning.log ? (std::log(ekin) - fLnEmin)*fInvWidth : (ekin - fBinning.emin)*fInvWidth;
+            return x < 0 ? -1 : (G4int)x;
+        }
+        G4double* Histogram(G4int voxel, G4bool create);
+        G4String Header(const G4String& grid) const;
+
+        SpectrumBinning fBinning;
+        G4double fLnEmin, fInvWidth;
+        G4int    fSlotsPerChunk;
+        G4long   fMaxSlots;
+
+        std::unordered_map<G4int, G4int> fSlots;          // voxel index -> histogram slot
+        std::vector<std::unique_ptr<G4double[]>> fChunks; // kChunk histograms each
+        G4double fDropped, fUnderflow, fOverflow;        // summed weights not binned
+};
+
+#endif
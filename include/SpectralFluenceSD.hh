@@ -0,0 +1,39 @@
+#ifndef SpectralFluenceSD_h
+#define SpectralFluenceSD_h 1
+
+#include "G4VSensitiveDetector.hh"
+#include "globals.hh"
+
+class RegionOfInterest;
+class SparseSpectra;
+
+/* Photon fluence spectra per voxel: counts photons passing through a voxel (entering and leaving through its boundary,
+ *   as photonFluence), weighted, in bins of their kinetic energy at entry.
+ * It shares the voxel volume with the "mfd" detector and fills the SparseSpectra of the current thread-local Run
+ *   directly, so no hits collections are created. Voxel indices follow the scoring grid (or compact ROI grid).
+ * With flatIndex (regular phantom), the voxel copy number is the ZYX index rather than one replica number per axis.
+ */
+class SpectralFluenceSD : public G4VSensitiveDetector
+{
+    public:
+        SpectralFluenceSD(const G4String& name);
+        virtual ~SpectralFluenceSD() {}
+
+        // scoring grid and optional region of interest; set before the first event
+        void SetGrid(G4int nx, G4int ny, G4int nz, const RegionOfInterest* roi, G4bool flatIndex);
+
+        virtual void Initialize(G4HCofThisEvent*);
+
+    protected:
+        virtual G4bool ProcessHits(G4Step* aStep, G4TouchableHistory*);
+
+    private:
+        G4int fNx, fNy, fNz;
+        const RegionOfInterest* fRoi;
+        G4bool fFlatIndex;
+        SparseSpectra* fSpectra; // of the current run
+        G4int fTrackID;          // track that entered the current voxel
+        G4double fEntryEnergy;
+};
+
+#endif
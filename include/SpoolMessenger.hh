@@ -0,0 +1,32 @@
+#ifndef SpoolMessenger_h
+#define SpoolMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class JobSpool;
+class G4UIdirectory;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithAString;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+class SpoolMessenger: public G4UImessenger
+{
+  public:
+
+    SpoolMessenger(JobSpool* );
+   ~SpoolMessenger();
+
+    void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+	G4UIdirectory				*Dir;
+    JobSpool					*fSpool;
+    G4UIcmdWithAString          *watchCmd;
+    G4UIcmdWithADoubleAndUnit   *pollCmd;
+    G4UIcmdWithADoubleAndUnit   *idleCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef StackingAction_h
+#define StackingAction_h 1
+
+#include "G4UserStackingAction.hh"
+#include "globals.hh"
+
+class KermaTable;
+
+/// Stacking action class; kills secondary electrons and positrons in kerma mode, where their energy is
+/// already scored by the kerma3d track-length estimator of the photons that set them in motion
+///
+
+class StackingAction : public G4UserStackingAction
+{
+  public:
+    StackingAction();
+    virtual ~StackingAction() {}
+
+    virtual G4ClassificationOfNewTrack ClassifyNewTrack(const G4Track*);
+
+  private:
+    const KermaTable& fKermaTable;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
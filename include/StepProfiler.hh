@@ -0,0 +1,57 @@
+#ifndef StepProfiler_h
+#define StepProfiler_h 1
+
+#include "globals.hh"
+
+#include <map>
+#include <unordered_map>
+#include <chrono>
+
+class G4Track;
+class G4Step;
+class G4ParticleDefinition;
+class G4VProcess;
+class G4LogicalVolume;
+
+/* Step, track and wall-time counters broken down by particle type, process and volume (build with -DWITH_PROFILING=ON).
+ * Each thread-local Run owns one instance that is only touched by its worker thread; counters are keyed by pointer so
+ *   that the hot path is a hash lookup and an increment, without locks.
+ * Merge() folds the counters of a worker into name-keyed tables (process objects are thread-local, names are not), which
+ *   are printed and written as CSV by the master RunAction.
+ * Wall time of a step is measured from the end of the previous step of the same track (or the start of the track).
+ */
+class StepProfiler
+{
+    public:
+        struct Counters {
+            G4long   steps  = 0;
+            G4long   tracks = 0;
+            G4double time   = 0; // [s]
+        };
+        typedef std::map<G4String, Counters> t_table;
+
+        void BeginTrack(const G4Track* track);
+        void EndStep(const G4Step* step);
+
+        // fold the (pointer-keyed) counters of a thread-local profiler into the name-keyed tables of this one;
+        //   in sequential mode the master run merges its own counters
+        void Merge(const StepProfiler& other);
+
+        G4bool IsEmpty() const;
+        void Print() const;
+        void WriteCSV(const G4String& fname) const;
+
+    private:
+        typedef std::chrono::steady_clock clock;
+        clock::time_point fStamp;
+
+        std::unordered_map<const G4ParticleDefinition*, Counters> fParticles;
+        std::unordered_map<const G4VProcess*, Counters>           fProcesses;
+        std::unordered_map<const G4LogicalVolume*, Counters>      fVolumes;
+
+        t_table fParticleTable;
+        t_table fProcessTable;
+        t_table fVolumeTable;
+};
+
+#endif
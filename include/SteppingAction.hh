@@ -5,6 +5,7 @@
 #include "globals.hh"
 
 class EventAction;
+class RunAction;
 
 class G4LogicalVolume;
 
@@ -14,14 +15,14 @@ class G4LogicalVolume;
 class SteppingAction : public G4UserSteppingAction
 {
   public:
-    SteppingAction();
+    SteppingAction(const RunAction* runAction);
     virtual ~SteppingAction();
 
     // method from the base class
     virtual void UserSteppingAction(const G4Step*);
 
   private:
-
+    const RunAction*     fRunAction;
 };
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,30 @@
+#ifndef TrackingAction_h
+#define TrackingAction_h 1
+
+#include "G4UserTrackingAction.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class RunAction;
+
+/// Tracking action class; follows the history (primary index) of every track for the per-history dose tally with
+/// several histories per event, and starts the per-track clock of the step profiler. Registered by RunAction
+///
+
+class TrackingAction : public G4UserTrackingAction
+{
+  public:
+    TrackingAction(const RunAction* runAction);
+    virtual ~TrackingAction() {}
+
+    virtual void PreUserTrackingAction(const G4Track*);
+
+  private:
+    const RunAction* fRunAction;
+    std::vector<G4int> fPrimaryOf; // index of the primary each track of the current event descends from, by track ID
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
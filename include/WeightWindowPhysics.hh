@@ -0,0 +1,23 @@
+#ifndef WeightWindowPhysics_h
+#define WeightWindowPhysics_h 1
+
+#include "G4VPhysicsConstructor.hh"
+#include "globals.hh"
+
+/// Adds the WeightWindowProcess to photons, last in the post step actions so that it sees the photon in its new
+/// voxel. It is inactive until a run with /det/vr/weightWindow enables it (RunAction)
+///
+
+class WeightWindowPhysics : public G4VPhysicsConstructor
+{
+  public:
+    WeightWindowPhysics(const G4String& name = "weightWindow");
+    virtual ~WeightWindowPhysics() {}
+
+    virtual void ConstructParticle() {}
+    virtual void ConstructProcess();
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef WeightWindowProcess_h
+#define WeightWindowProcess_h 1
+
+#include "G4VProcess.hh"
+#include "G4ParticleChange.hh"
+#include "globals.hh"
+
+class ImportanceMap;
+
+/// Photon weight windows of the ImportanceMap (/det/vr/weightWindow) as a process: forced at the end of every photon
+/// step, after transportation, so that splitting and roulette act when a photon has entered a new voxel. Copies are
+/// secondaries of this process. Registered by WeightWindowPhysics and only active in runs with the window enabled.
+/// Geant4's G4WeightWindowProcess identifies a cell by its volume and replica number, which does not resolve the
+/// voxels of the nested replica phantom.
+///
+
+class WeightWindowProcess : public G4VProcess
+{
+  public:
+    WeightWindowProcess(const G4String& name = "weightWindow");
+    virtual ~WeightWindowProcess() {}
+
+    virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+
+    virtual G4double PostStepGetPhysicalInteractionLength(const G4Track&, G4double, G4ForceCondition* condition);
+    virtual G4VParticleChange* PostStepDoIt(const G4Track& track, const G4Step& step);
+
+    // no along step or at rest actions
+    virtual G4double AlongStepGetPhysicalInteractionLength(const G4Track&, G4double, G4double, G4double&, G4GPILSelection*) { return -1.; }
+    virtual G4double AtRestGetPhysicalInteractionLength(const G4Track&, G4ForceCondition*) { return -1.; }
+    virtual G4VParticleChange* AlongStepDoIt(const G4Track&, const G4Step&) { return 0; }
+    virtual G4VParticleChange* AtRestDoIt(const G4Track&, const G4Step&) { return 0; }
+
+  private:
+    const ImportanceMap& fImportanceMap;
+    G4ParticleChange     fParticleChange;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef WoodcockModel_h
+#define WoodcockModel_h 1
+
+#include "G4VFastSimulationModel.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class G4Material;
+class G4MaterialCutsCouple;
+class G4VProcess;
+class G4Track;
+class G4Step;
+
+/* Woodcock (delta) tracking of photons inside the phantom box (envelope: the "phantom" region).
+ * Instead of stepping from voxel boundary to voxel boundary, the photon flies distances sampled from the maximum
+ *   attenuation coefficient mu_max(E) over all phantom materials. At each tentative collision the voxel material is
+ *   looked up and the collision is accepted as real with probability mu(material, E)/mu_max(E); fictitious collisions
+ *   leave the photon unchanged.
+ * A real collision is performed by the discrete photon process (phot, compt, conv, Rayl) sampled in proportion to its
+ *   cross section, by calling its PostStepDoIt() on a helper track placed at the collision point. Each DoIt() advances
+ *   the photon to its next real collision (or to the envelope surface), so photon steps scale with the number of
+ *   interactions rather than the number of voxels crossed.
+ * Electrons and positrons are not handled and follow the normal transport. Local energy deposits of an interaction are
+ *   handed on as an electron of that energy at the collision point so that they are scored in the right voxel.
+ * Cross sections are tabulated per thread on a log energy grid on first use (after the physics tables are built).
+ */
+class WoodcockModel : public G4VFastSimulationModel
+{
+    public:
+        // voxel data in ZYX ordering, as held by DetectorConstruction
+        WoodcockModel(const G4String& name, G4Region* envelope, G4int nx, G4int ny, G4int nz, G4double dx, G4double dy,
+                G4double dz, const std::vector<G4int>& matMap, const std::vector<G4Material*>& matVec);
+        virtual ~WoodcockModel();
+
+        virtual G4bool IsApplicable(const G4ParticleDefinition& particle);
+        virtual G4bool ModelTrigger(const G4FastTrack& fastTrack);
+        virtual void   DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep);
+
+        // new phantom after a geometry reload; matMap/matVec are read by reference, tables are rebuilt on next use
+        void SetPhantom(G4int nx, G4int ny, G4int nz, G4double dx, G4double dy, G4double dz);
+
+    private:
+        void BuildTables();
+        G4double Lookup(const std::vector<G4double>& table, G4double lnE) const;
+        G4int    VoxelMaterial(const G4ThreeVector& localPos) const;
+        void     Interact(const G4FastTrack& fastTrack, G4FastStep& fastStep, G4int mat, G4double ekin,
+                const G4ThreeVector& localPos, G4double time, G4double mu);
+
+        G4Region* fRegion;
+        G4int    fNx, fNy, fNz;
+        G4double fDx, fDy, fDz;
+        const std::vector<G4int>&       fMatMap;
+        const std::vector<G4Material*>& fMatVec;
+
+        // cross section tables [1/mm] on a log energy grid
+        G4bool   fTablesBuilt;
+        G4int    fNbins;
+        G4double fEmin, fEmax, fLnEmin, fInvDlnE;
+        std::vector<G4VProcess*>                        fProcesses;  // discrete gamma processes
+        std::vector<std::vector<std::vector<G4double>>> fMuProcess;  // [material][process][bin]
+        std::vector<std::vector<G4double>>              fMuTotal;    // [material][bin]
+        std::vector<G4double>                           fMuMax;      // [bin]
+        std::vector<const G4MaterialCutsCouple*>        fCouples;    // [material]
+
+        // helper track and step used to call the process at a collision point
+        G4Track* fTmpTrack;
+        G4Step*  fTmpStep;
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef WorkerInitialization_h
+#define WorkerInitialization_h 1
+
+#include "G4UserWorkerInitialization.hh"
+#include "globals.hh"
+
+#include <vector>
+
+class WorkerMessenger;
+
+/* Pins each worker thread to CPUs when it starts, before it allocates any of its scoring buffers.
+ * Policies:
+ *   none: leave placement to the OS scheduler (default)
+ *   core: worker i is pinned to a single CPU; CPUs are taken node by node (compact), so the first workers fill node 0
+ *   node: worker i is pinned to all CPUs of NUMA node (i mod nodes) (scatter)
+ * Thread-local Run accumulators and G4THitsMap entries are allocated and first written by their worker, so once a
+ *   worker is pinned its scoring memory is placed on its own node by the kernel's first-touch policy.
+ * NUMA topology is read from /sys/devices/system/node; without it all CPUs are treated as a single node.
+ */
+class WorkerInitialization : public G4UserWorkerInitialization
+{
+    public:
+        WorkerInitialization();
+        virtual ~WorkerInitialization();
+
+        virtual void WorkerStart() const;
+
+        void SetPinning(const G4String& policy) { fPolicy = policy; }
+        const G4String& GetPinning() const { return fPolicy; }
+        void PrintTopology() const;
+
+    private:
+        void ReadTopology();
+
+        WorkerMessenger* fMessenger;
+        G4String fPolicy;
+        std::vector<std::vector<G4int>> fNodeCpus; // cpus of each NUMA node
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef WorkerMessenger_h
+#define WorkerMessenger_h 1
+
+#include "globals.hh"
+#include "G4UImessenger.hh"
+
+class WorkerInitialization;
+class G4UIdirectory;
+class G4UIcmdWithAString;
+class G4UIcmdWithoutParameter;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+class WorkerMessenger: public G4UImessenger
+{
+  public:
+
+    WorkerMessenger(WorkerInitialization* );
+   ~WorkerMessenger();
+
+    void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+	G4UIdirectory				*Dir;
+    WorkerInitialization		*fWorkerInit;
+    G4UIcmdWithAString          *pinningCmd;
+    G4UIcmdWithoutParameter     *topologyCmd;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+#endif
@@ -4,6 +4,7 @@
 #include "RunAction.hh"
 #include "EventAction.hh"
 #include "SteppingAction.hh"
+#include "StackingAction.hh"
 
 #include "G4String.hh"
 #include <vector>
@@ -30,5 +31,7 @@ void AllActionInitialization::Build() const
 	RunAction *RA = new RunAction();
 	SetUserAction(RA);
     SetUserAction(new EventAction());
-	SetUserAction(new SteppingAction());
+	SetUserAction(new SteppingAction(RA));
+	SetUserAction(new StackingAction());
+	// the TrackingAction is registered by RunAction at the start of each run, only when it is needed
 }
@@ -0,0 +1,342 @@
+#include "Checkpoint.hh"
+#include "CheckpointMessenger.hh"
+#include "DoseEngine.hh"
+
+#include "G4UImanager.hh"
+#include "G4RunManager.hh"
+#include "Randomize.hh"
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <cstdio>
+#include <csignal>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+    G4bool IsDir(const G4String& path) {
+        struct stat st;
+        return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    }
+
+    void RemoveDir(const G4String& path) {
+        // checkpoint directories are flat
+        DIR* dir = opendir(path.c_str());
+        if (!dir) { return; }
+        while (struct dirent* entry = readdir(dir)) {
+            std::string fname = entry->d_name;
+            if (fname != "." && fname != "..") { std::remove((path + "/" + fname).c_str()); }
+        }
+        closedir(dir);
+        rmdir(path.c_str());
+    }
+
+    G4bool CopyFile(const G4String& from, const G4String& to) {
+        std::ifstream in(from.c_str(), std::ios::in | std::ios::binary);
+        std::ofstream out(to.c_str(), std::ios::out | std::ios::binary);
+        if (!in.is_open() || !out.is_open()) { return false; }
+        out << in.rdbuf();
+        return out.good();
+    }
+
+    std::string Trim(const std::string& s) {
+        size_t first = s.find_first_not_of(" \t\r");
+        if (first == std::string::npos) { return ""; }
+        return s.substr(first, s.find_last_not_of(" \t\r") - first + 1);
+    }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Checkpoint* Checkpoint::instance = 0;
+std::atomic<int> Checkpoint::sSignal(0);
+
+Checkpoint* Checkpoint::getInstance()
+{
+    if (instance == 0) instance = new Checkpoint();
+    return instance;
+}
+
+Checkpoint::Checkpoint()
+    : fInterval(0), fDeadline(0), fStopped(false),
+    fRunIndex(0), fRemaining(0),
+    fRestorePending(false), fResumeRuns(0), fResumeRemaining(0), fResumeEvents(0), fResumeThreads(0)
+{
+    fMessenger = new CheckpointMessenger(this);
+}
+
+Checkpoint::~Checkpoint()
+{
+    delete fMessenger;
+}
+
+void Checkpoint::HandleSignal(int signum)
+{
+    // only a lock-free atomic store is safe here; workers see it at the end of their current event
+    sSignal.store(signum, std::memory_order_relaxed);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool Checkpoint::Start(const G4String& dir, G4bool resume)
+{
+    fDir = dir;
+    fLastWrite = std::chrono::steady_clock::now();
+    std::signal(SIGTERM, &Checkpoint::HandleSignal);
+    std::signal(SIGUSR1, &Checkpoint::HandleSignal);
+    G4cout << "Checkpointing to \"" << fDir << "\" (stop with SIGTERM or SIGUSR1)" << G4endl;
+    if (!resume) { return true; }
+
+    // a crash between the two renames in Write() leaves only the previous checkpoint
+    G4String from = IsDir(fDir) ? fDir : fDir + ".old";
+    if (!Read(from)) {
+        G4cerr << "Checkpoint: no usable checkpoint in \"" << fDir << "\"" << G4endl;
+        return false;
+    }
+    return true;
+}
+
+G4bool Checkpoint::Read(const G4String& dir)
+{
+    std::ifstream state((dir + "/state.txt").c_str());
+    if (!state.is_open()) { return false; }
+
+    std::vector<G4String> outputs;
+    std::string key;
+    while (state >> key) {
+        if (key == "completedRuns")        { state >> fResumeRuns; }
+        else if (key == "remainingEvents") { state >> fResumeRemaining; }
+        else if (key == "eventsProcessed") { state >> fResumeEvents; }
+        else if (key == "threads")         { state >> fResumeThreads; }
+        else if (key == "output") {
+            std::string fname;
+            std::getline(state, fname);
+            outputs.push_back(Trim(fname));
+        } else {
+            std::getline(state, key);
+        }
+    }
+
+    // cumulative outputs as of the checkpoint; anything written after it is replaced
+    for (const auto& fname : outputs) {
+        if (!CopyFile(dir + "/" + fname, fname)) {
+            G4cerr << "Checkpoint: cannot restore output \"" << fname << "\"" << G4endl;
+            return false;
+        }
+        fOutputs.insert(fname);
+    }
+
+    std::ifstream threads((dir + "/threads.txt").c_str());
+    G4int tid;
+    std::string line;
+    while (threads >> tid && std::getline(threads, line)) {
+        fThreadStates[tid] = fPendingStates[tid] = Trim(line);
+    }
+
+    fRestoreDir = dir;
+    fRestorePending = true;
+    G4cout << "Resuming from checkpoint \"" << dir << "\": " << fResumeRuns << " runs completed, " << fResumeEvents
+        << " events processed";
+    if (fResumeRemaining > 0) { G4cout << ", " << fResumeRemaining << " events left in the interrupted run"; }
+    G4cout << G4endl;
+    return true;
+}
+
+void Checkpoint::RestoreState()
+{
+    // called right before the first beamOn that is actually run, after the replayed commands (e.g. /random/setSeeds)
+    fRestorePending = false;
+    G4Random::restoreEngineStatus((fRestoreDir + "/master.rndm").c_str());
+    DoseEngine::getInstance()->SetEventsProcessed(fResumeEvents);
+    if (fResumeThreads != G4RunManager::GetRunManager()->GetNumberOfThreads()) {
+        G4cerr << "Checkpoint: written with " << fResumeThreads << " threads, now running "
+            << G4RunManager::GetRunManager()->GetNumberOfThreads() << "; per-thread source state is not restored" << G4endl;
+        std::lock_guard<std::mutex> lock(fMutex);
+        fPendingStates.clear();
+        fThreadStates.clear();
+    }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::Write()
+{
+    G4String tmp = fDir + ".tmp";
+    G4String old = fDir + ".old";
+    RemoveDir(tmp);
+    if (mkdir(tmp.c_str(), 0755) != 0) {
+        G4cerr << "Checkpoint: cannot create \"" << tmp << "\"" << G4endl;
+        return;
+    }
+
+    std::ofstream state((tmp + "/state.txt").c_str());
+    state << "completedRuns " << (fRemaining > 0 ? fRunIndex-1 : fRunIndex) << G4endl;
+    state << "remainingEvents " << fRemaining << G4endl;
+    state << "eventsProcessed " << DoseEngine::getInstance()->GetEventsProcessed() << G4endl;
+    state << "threads " << G4RunManager::GetRunManager()->GetNumberOfThreads() << G4endl;
+    for (const auto& fname : fOutputs) {
+        if (access(fname.c_str(), F_OK) != 0) { continue; }
+        if (!CopyFile(fname, tmp + "/" + fname)) {
+            G4cerr << "Checkpoint: cannot copy output \"" << fname << "\"; checkpoint not written" << G4endl;
+            return;
+        }
+        state << "output " << fname << G4endl;
+    }
+
+    G4Random::saveEngineStatus((tmp + "/master.rndm").c_str());
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        std::ofstream threads((tmp + "/threads.txt").c_str());
+        for (const auto& it : fThreadStates) {
+            threads << it.first << " " << it.second << G4endl;
+        }
+    }
+    state.close();
+    if (!state) {
+        G4cerr << "Checkpoint: error writing \"" << tmp << "/state.txt\"; checkpoint not written" << G4endl;
+        return;
+    }
+
+    if (IsDir(fDir)) {
+        RemoveDir(old);
+        std::rename(fDir.c_str(), old.c_str());
+    }
+    if (std::rename(tmp.c_str(), fDir.c_str()) != 0) {
+        G4cerr << "Checkpoint: cannot move \"" << tmp << "\" to \"" << fDir << "\"" << G4endl;
+        return;
+    }
+    RemoveDir(old);
+    fLastWrite = std::chrono::steady_clock::now();
+    G4cout << "Checkpoint written: run " << fRunIndex << " (" << fRemaining << " events left), "
+        << DoseEngine::getInstance()->GetEventsProcessed() << " events processed" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool Checkpoint::ExecuteMacro(const G4String& fname)
+{
+    G4UImanager* UI = G4UImanager::GetUIpointer();
+    std::ifstream macro(UI->FindMacroPath(fname).c_str());
+    if (!macro.is_open()) {
+        G4cerr << "Checkpoint: cannot open macro file \"" << fname << "\"" << G4endl;
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(macro, line)) {
+        // same conventions as /control/execute: '#' starts a comment, and a failing command aborts the macro
+        line = Trim(line.substr(0, line.find('#')));
+        if (line.empty()) { continue; }
+        std::istringstream is(line);
+        std::string cmd, args;
+        is >> cmd;
+        std::getline(is, args);
+        args = Trim(args);
+
+        if (cmd == "/control/execute") {
+            if (!ExecuteMacro(UI->SolveAlias(args.c_str()))) { return false; }
+            continue;
+        } else if (cmd == "/run/beamOn") {
+            if (!BeamOn(UI->SolveAlias(args.c_str()))) { return false; }
+            continue;
+        } else if (cmd == "/control/loop" || cmd == "/control/foreach") {
+            G4cerr << "Checkpoint: runs started by \"" << cmd << "\" are not counted and will be repeated on resume" << G4endl;
+        }
+
+        G4int status = UI->ApplyCommand(line);
+        if (status != 0) {
+            G4cerr << "Checkpoint: command \"" << line << "\" failed (" << status << "); macro \"" << fname << "\" aborted" << G4endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+G4bool Checkpoint::BeamOn(const G4String& args)
+{
+    std::istringstream is(args);
+    G4long nevents = 1;
+    std::string rest;
+    is >> nevents;
+    std::getline(is, rest);
+
+    ++fRunIndex;
+    if (fRestorePending && fRunIndex <= fResumeRuns) {
+        G4cout << "Checkpoint: skipping /run/beamOn #" << fRunIndex << " (completed before the restart)" << G4endl;
+        return true;
+    }
+    if (fRestorePending) {
+        if (fResumeRemaining > 0) { nevents = fResumeRemaining; }
+        RestoreState();
+    }
+
+    fRemaining = nevents;
+    while (fRemaining > 0) {
+        if (sSignal.load() != 0) {
+            Write();
+            fStopped = true;
+            return false;
+        }
+        if (fInterval > 0) {
+            auto deadline = fLastWrite + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<G4double>(fInterval));
+            fDeadline.store(deadline.time_since_epoch().count());
+        }
+
+        long int before = DoseEngine::getInstance()->GetEventsProcessed();
+        std::ostringstream cmd;
+        cmd << "/run/beamOn " << fRemaining << rest;
+        G4int status = G4UImanager::GetUIpointer()->ApplyCommand(cmd.str());
+        fDeadline.store(0);
+        if (status != 0) { return false; }
+
+        long int done = DoseEngine::getInstance()->GetEventsProcessed() - before;
+        fRemaining -= done;
+        if (fRemaining < 0) { fRemaining = 0; }
+
+        G4bool interrupted = fRemaining > 0;
+        G4bool due = fInterval <= 0 || std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fLastWrite).count() >= fInterval;
+        if (interrupted || due || sSignal.load() != 0) { Write(); }
+        if (sSignal.load() != 0) {
+            G4cout << "Checkpoint: stopped by signal " << sSignal.load() << G4endl;
+            fStopped = true;
+            return false;
+        }
+        if (interrupted && done == 0) {
+            G4cerr << "Checkpoint: no events processed in run #" << fRunIndex << "; giving up" << G4endl;
+            return false;
+        }
+        if (interrupted) {
+            G4cout << "Checkpoint: continuing run #" << fRunIndex << " with the remaining " << fRemaining << " events" << G4endl;
+        }
+    }
+    return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void Checkpoint::AddOutput(const G4String& fname)
+{
+    fOutputs.insert(fname);
+}
+
+void Checkpoint::SetThreadState(G4int threadID, const G4String& state)
+{
+    std::lock_guard<std::mutex> lock(fMutex);
+    fThreadStates[threadID] = state;
+}
+
+G4bool Checkpoint::TakeThreadState(G4int threadID, G4String& state)
+{
+    // each worker picks up its saved state once, at the start of the first run after the restart
+    std::lock_guard<std::mutex> lock(fMutex);
+    if (fRestorePending) { return false; }
+    auto it = fPendingStates.find(threadID);
+    if (it == fPendingStates.end()) { return false; }
+    state = it->second;
+    fPendingStates.erase(it);
+    return !state.empty();
+}
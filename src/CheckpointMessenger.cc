@@ -0,0 +1,38 @@
+#include "CheckpointMessenger.hh"
+#include "Checkpoint.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CheckpointMessenger::CheckpointMessenger(Checkpoint * checkpoint)
+:fCheckpoint(checkpoint)
+{
+  Dir = new G4UIdirectory("/checkpoint/");
+  Dir->SetGuidance(" Checkpoint/restart (enabled with --checkpoint <dir> or --resume <dir> on the command line).");
+
+  intervalCmd = new G4UIcmdWithADoubleAndUnit("/checkpoint/interval", this);
+  intervalCmd->SetGuidance("Write a checkpoint at this interval, interrupting the current run if needed (0: after every run).");
+  intervalCmd->SetParameterName("interval", false);
+  intervalCmd->SetRange("interval>=0");
+  intervalCmd->SetDefaultUnit("s");
+  intervalCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+CheckpointMessenger::~CheckpointMessenger()
+{
+    delete   intervalCmd;
+	delete   Dir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void CheckpointMessenger::SetNewValue(G4UIcommand* command,G4String newValue) {
+    if (command == intervalCmd) {
+        fCheckpoint->SetInterval(intervalCmd->GetNewDoubleValue(newValue)/s);
+    }
+}
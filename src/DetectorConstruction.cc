@@ -26,15 +26,34 @@
 
 //G4PVParameterised and nestedparam for CT materials
 #include "G4PVParameterised.hh"
+#include "G4GeometryManager.hh"
+#include "G4VPVParameterisation.hh"
 #include "NestedParam.hh"
+#include "RegularParam.hh"
 
 //For Scoring
 #include "G4SDManager.hh"
 #include "G4MultiFunctionalDetector.hh"
+#include "G4VPrimitiveScorer.hh"
 #include "G4PSDoseDeposit3D.hh"
 #include "G4SDParticleFilter.hh"
 #include "G4PSPassageCellCurrent3D.hh"
+#include "G4PSCellFlux3D.hh"
 #include "G4UserParticleWithDirectionFilter.hh"
+#include "RoiScorer.hh"
+#include "ScoringWorld.hh"
+#include "FusedScorer.hh"
+#include "SpectralFluenceSD.hh"
+
+//Regions for production cuts and step limits
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+
+//Woodcock photon tracking (fast simulation model on the phantom region)
+#include "WoodcockModel.hh"
+#include "PhysicsList.hh"
+#include "DoseEngine.hh"
 
 //Quality of Life includes
 #include "G4NistManager.hh"
@@ -47,9 +66,19 @@
 #include <fstream>
 #include <vector>
 #include <list>
+#include <set>
 #include <exception>
 
-extern G4String g_geoFname;
+// quantities scored by the fused detector, in the order of the Attach<I>() calls in CreateFusedDetector()
+typedef FusedDetector<
+    ScoreChannelOf<ScoreQuantity::Dose,    ScoreFilter::Any>,                                                       // dose3d
+    ScoreChannelOf<ScoreQuantity::Passage, ScoreFilter::Gamma>,                                                     // photonFluence
+    ScoreChannelOf<ScoreQuantity::Dose,    ScoreFilter::And<ScoreFilter::Electrons, ScoreFilter::AlongZ<1> > >,     // fedose3d
+    ScoreChannelOf<ScoreQuantity::Dose,    ScoreFilter::And<ScoreFilter::Electrons, ScoreFilter::AlongZ<-1> > >,    // bedose3d
+    ScoreChannelOf<ScoreQuantity::TrackLength, ScoreFilter::Gamma>,                                                 // photonFluenceTL
+    ScoreChannelOf<ScoreQuantity::TrackLength, ScoreFilter::Electrons>,                                             // electronFluenceTL
+    ScoreChannelOf<ScoreQuantity::Kerma, ScoreFilter::Gamma>                                               // kerma3d
+> DoseDetector;
 
 using namespace std;
 DetectorConstruction* DetectorConstruction::instance = 0;
@@ -61,6 +90,15 @@ DetectorConstruction* DetectorConstruction::getInstance()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 DetectorConstruction::DetectorConstruction()
+	: lWorld(0), pVoxel(0), fWorld(0), fPhantomBox(0),
+	fConstructCount(0),
+	fMemoryPhantom(false),
+	fPhantomType("nested"),
+	fScoringWorld(0),
+	fFusedScoring(false), fDirectionalDose(false), fTrackLengthFluence(false), fKermaScoring(false),
+	fHistoriesPerEvent(1), fHistoryUncertainty(false),
+	fFastForward(false), fAirAttenuation(false), fAutoWorld(false),
+	fSourcePos(0, 0, -110*cm)
 {
 	dMess = new DetectorMessenger(this);
 }
@@ -74,10 +112,61 @@ DetectorConstruction::~DetectorConstruction()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+void DetectorConstruction::DestroyGeometry()
+{
+	// /run/reinitializeGeometry only rebuilds, and its destroyFirst variant would also clear the scoring mesh
+	// world, so the mass world tree of the previous Construct() is deleted here before the new one is built
+	G4GeometryManager::GetInstance()->OpenGeometry();
+	G4Region* phantomRegion = G4RegionStore::GetInstance()->GetRegion("phantom", false);
+	if (phantomRegion && fPhantomBox) phantomRegion->RemoveRootLogicalVolume(fPhantomBox, false);
+	G4Region* worldRegion = G4RegionStore::GetInstance()->GetRegion("DefaultRegionForTheWorld", false);
+	if (worldRegion) worldRegion->RemoveRootLogicalVolume(lWorld, false);
+
+	std::vector<G4VPhysicalVolume*> pvs(1, fWorld);
+	std::vector<G4LogicalVolume*> lvs;
+	std::set<G4LogicalVolume*> seenLV;
+	std::set<G4VSolid*> solids;
+	std::set<G4VPVParameterisation*> params;
+	for (size_t i = 0; i < pvs.size(); i++) {
+		G4VPhysicalVolume* pv = pvs[i];
+		if (pv->IsParameterised() && pv->GetParameterisation()) params.insert(pv->GetParameterisation());
+		G4LogicalVolume* lv = pv->GetLogicalVolume();
+		if (!seenLV.insert(lv).second) continue;
+		lvs.push_back(lv);
+		solids.insert(lv->GetSolid());
+		for (size_t d = 0; d < lv->GetNoDaughters(); d++) pvs.push_back(lv->GetDaughter(d));
+	}
+	for (auto pv : pvs) delete pv;
+	for (auto lv : lvs) delete lv;
+	for (auto s : solids) delete s;
+	for (auto pp : params) delete pp;
+
+	fWorld = 0;
+	lWorld = 0;
+	fPhantomBox = 0;
+	pVoxel = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 G4VPhysicalVolume* DetectorConstruction::Construct()
 {
 
 	G4cout << "Entering DetectorConstruction::Construct()" << G4endl;
+	DoseEngine::getInstance()->GetInitTimer().Start();
+	fConstructCount++;
+
+	//on a geometry reload (/det/geo) the previous phantom is discarded; materials stay in matCache
+	if (fWorld) {
+		DestroyGeometry();
+	}
+	matty.clear();
+	densList.clear();
+	densVec.clear();
+	matVec.clear();
+	matMap.clear();
+	fImportanceMap.Clear();
+	fKermaTable.Clear();
 
 	G4double wx, wy, wz;
     wx = wy = 30 * cm;
@@ -89,16 +178,46 @@ G4VPhysicalVolume* DetectorConstruction::Construct()
 	G4Air = man->FindOrBuildMaterial("G4_AIR");
     G4Water = man->FindOrBuildMaterial("G4_WATER");
 
+	//compile and run, visualize
+    if (fMemoryPhantom) {
+        ReadPhantomFromMemory();
+    } else {
+        ReadPhantom();
+    }
+    MapMaterials();
+
+    // the scoring mesh is built by the run manager after this world; only its grid is resolved here
+    if (fScoringWorld) {
+        G4ThreeVector lo, hi;
+        GetPhantomBounds(lo, hi);
+        fScoringWorld->SetupGrid(lo, hi);
+    }
+    G4int sx, sy, sz;
+    GetScoringGrid(sx, sy, sz);
+    fRoi.Build(sx, sy, sz);
+
+    if (fAutoWorld) {
+        // smallest origin-centered box holding the phantom and the source, with a margin for the beam divergence
+        G4ThreeVector lo, hi;
+        GetPhantomBounds(lo, hi);
+        G4double margin = 5 * cm;
+        wx = 2*(std::max(std::max(std::fabs(lo.x()), std::fabs(hi.x())), std::fabs(fSourcePos.x())) + margin);
+        wy = 2*(std::max(std::max(std::fabs(lo.y()), std::fabs(hi.y())), std::fabs(fSourcePos.y())) + margin);
+        wz = 2*(std::max(std::max(std::fabs(lo.z()), std::fabs(hi.z())), std::fabs(fSourcePos.z())) + margin);
+        G4cout << "World size (cm): " << wx/cm << " " << wy/cm << " " << wz/cm << G4endl;
+    }
+
 	G4Box *sWorld = new G4Box("world", wx / 2., wy / 2., wz / 2.);
 	lWorld = new G4LogicalVolume(sWorld, G4Air, "World");
 	G4VPhysicalVolume *pWorld = new G4PVPlacement(0, G4ThreeVector(), lWorld, "World", 0, false, 0);
+	fWorld = pWorld;
 
-	//compile and run, visualize
-    ReadPhantom();
-    MapMaterials();
     CreatePhantom();
 
     SanityCheck();
+    if (fImportanceMap.IsEnabled()) {
+        BuildImportanceMap();
+    }
 	return pWorld;
 }
 
@@ -107,7 +226,7 @@ void DetectorConstruction::ReadPhantom() {
 	std::stringstream ss;
 
 	std::ifstream infile;
-	infile.open(g_geoFname);
+	infile.open(DoseEngine::getInstance()->GetGeometryFile());
 
 	if (!infile.is_open()){
 		G4cerr << "Failed opening Geometry" << G4endl;
@@ -158,6 +277,39 @@ void DetectorConstruction::ReadPhantom() {
     }
 }
 
+void DetectorConstruction::SetPhantom(const PhantomSpec& spec) {
+	fPhantomSpec = spec;
+	fMemoryPhantom = true;
+}
+
+void DetectorConstruction::ReadPhantomFromMemory() {
+	const PhantomSpec& spec = fPhantomSpec;
+	nx = spec.nx; ny = spec.ny; nz = spec.nz;
+	dx = spec.dx; dy = spec.dy; dz = spec.dz;
+	px = spec.px; py = spec.py; pz = spec.pz;
+	nxyz = (G4long)nx*ny*nz;
+
+	G4cout << "Array size: " << nx <<" "<< ny << " " << nz << G4endl <<
+              "Voxel size (mm): "<< dx << " " << dy << " " << dz << G4endl <<
+              "Center Position (mm): " << px << " " << py << " " << pz << " (in-memory phantom)" << G4endl;
+
+	if ((G4long)spec.density.size() != nxyz || (G4long)spec.material.size() != nxyz) {
+		G4cerr << "mismatch between nxyz and the size of the phantom arrays" << G4endl;
+		throw runtime_error("mismatch between nxyz and the size of the phantom arrays");
+	}
+
+	// same representation as a geometry file, so that materials are mapped and cached identically
+	matty.resize(nxyz);
+	for (G4long i = 0; i < nxyz; i++) {
+		matStruct& temp = matty[i];
+		temp.den = spec.density[i]*g/cm3;
+		temp.numMat = 1;
+		temp.matID1 = spec.material[i];
+		temp.frac1 = 1;
+		densList.push_back(temp.den);
+	}
+}
+
 void DetectorConstruction::MapMaterials() {
 
 	//List has sort and unique, vector has random access
@@ -208,8 +360,18 @@ void DetectorConstruction::CreateMaterial(G4long i, G4int idx) {
 	//local variables easier to work with
     const auto& mat = matty[i];
 
-	std::stringstream ss; //holder for material name
-	ss << "mat" << idx;
+	if (mat.numMat != 1) { throw runtime_error("multi-material voxels not yet implemented"); }
+
+	//reuse the material of a previously loaded phantom with the same base material and density
+	std::pair<G4int, G4double> key(mat.matID1, mat.den);
+	auto cached = matCache.find(key);
+	if (cached != matCache.end()) {
+		matVec[idx] = cached->second;
+		return;
+	}
+
+	std::stringstream ss; //holder for material name, unique across reloads
+	ss << "mat" << mat.matID1 << "_" << mat.den/(g/cm3);
 
 	if (mat.numMat == 1) { //easy, just making one material
 		if (mat.matID1 == 0) //water
@@ -230,7 +392,8 @@ void DetectorConstruction::CreateMaterial(G4long i, G4int idx) {
 			matVec[idx] = man->BuildMaterialWithNewDensity(ss.str(), "G4_Al", mat.den);
         else
             throw runtime_error("material undefined");
-    } else { throw runtime_error("multi-material voxels not yet implemented"); }
+    }
+	matCache[key] = matVec[idx];
 }
 
 void DetectorConstruction::CreatePhantom() {
@@ -242,7 +405,25 @@ void DetectorConstruction::CreatePhantom() {
 
 	G4Box * sBox = new G4Box("sBox", boxx / 2., boxy / 2., boxz / 2.);
 	G4LogicalVolume *lBox = new G4LogicalVolume(sBox, G4Water, "lBox");
-	new G4PVPlacement(0, G4ThreeVector(px, py, pz), lBox, "pBox", lWorld, false, 0, true);
+	G4VPhysicalVolume *pBox = new G4PVPlacement(0, G4ThreeVector(px, py, pz), lBox, "pBox", lWorld, false, 0, true);
+
+	// the phantom gets its own region so that cuts/limits can differ from the surrounding air (DefaultRegionForTheWorld)
+	G4Region* phantomRegion = G4RegionStore::GetInstance()->FindOrCreateRegion("phantom");
+	phantomRegion->AddRootLogicalVolume(lBox);
+	fPhantomBox = lBox;
+	if (!phantomRegion->GetProductionCuts()) {
+		// own cuts object, starting at the default cut: otherwise the region shares the world cuts and a world cut set
+		// with /phys/region/setCut would also apply to the phantom
+		G4ProductionCuts* cuts = new G4ProductionCuts();
+		const G4VUserPhysicsList* physics = G4RunManager::GetRunManager()->GetUserPhysicsList();
+		if (physics) { cuts->SetProductionCut(physics->GetDefaultCutValue()); }
+		phantomRegion->SetProductionCuts(cuts);
+	}
+
+	if (!IsNestedPhantom()) {
+		CreateRegularPhantom(lBox, pBox);
+		return;
+	}
 
 	G4VSolid *sRepZ = new G4Box("sRepZ", boxx / 2., boxy / 2., dz / 2.);
 	G4LogicalVolume *lRepZ = new G4LogicalVolume(sRepZ, G4Air, "lRepZ");
@@ -261,7 +442,78 @@ void DetectorConstruction::CreatePhantom() {
     param->SetDimVoxel(dx, dy, dz);
     param->SetNoVoxel(nx, ny, nz);
 
-	new G4PVParameterised("ctVox", lRepX, lRepY, kXAxis, nx, param); //a parameterised pvplacement
+	pVoxel = new G4PVParameterised("ctVox", lRepX, lRepY, kXAxis, nx, param); //a parameterised pvplacement
+}
+
+void DetectorConstruction::CreateRegularPhantom(G4LogicalVolume* lBox, G4VPhysicalVolume* pBox) {
+	// all voxels are copies of one parameterised volume directly in the phantom box; the copy number is the voxel index
+	// in ZYX ordering, so scorers read the index from depth 0 instead of the three replica depths
+	fRegularIndices.assign(matMap.begin(), matMap.end());
+
+	RegularParam* param = new RegularParam();
+	param->SetVoxelDimensions(dx / 2., dy / 2., dz / 2.);
+	param->SetNoVoxel(nx, ny, nz);
+	param->SetMaterials(matVec);
+	param->SetMaterialIndices(fRegularIndices.data());
+	param->BuildContainerSolid(pBox);
+	param->CheckVoxelsFillContainer(nx*dx / 2., ny*dy / 2., nz*dz / 2.);
+	param->SetSkipEqualMaterials(fPhantomType == "regularSkip");
+
+	G4VSolid *sVoxel = new G4Box("sVoxel", dx / 2., dy / 2., dz / 2.);
+	G4LogicalVolume *lVoxel = new G4LogicalVolume(sVoxel, G4Water, "lVoxel");
+	G4PVParameterised *pRegular = new G4PVParameterised("ctVox", lVoxel, lBox, kUndefined, nxyz, param);
+	pRegular->SetRegularStructureId(1);	//G4RegularNavigation
+	pVoxel = pRegular;
+}
+
+void DetectorConstruction::GetPhantomBounds(G4ThreeVector& lo, G4ThreeVector& hi) const {
+	G4ThreeVector half(nx*dx/2., ny*dy/2., nz*dz/2.);
+	lo = G4ThreeVector(px, py, pz) - half;
+	hi = G4ThreeVector(px, py, pz) + half;
+}
+
+void DetectorConstruction::EnableScoringMesh() {
+	if (fScoringWorld) {
+		return;
+	}
+	fScoringWorld = new ScoringWorld("scoringWorld");
+	RegisterParallelWorld(fScoringWorld);
+	PhysicsList* physics = static_cast<PhysicsList*>(const_cast<G4VUserPhysicsList*>(G4RunManager::GetRunManager()->GetUserPhysicsList()));
+	physics->AddParallelWorld(fScoringWorld->GetName());
+}
+
+void DetectorConstruction::GetScoringGrid(G4int& sx, G4int& sy, G4int& sz) const {
+	if (fScoringWorld) {
+		sx = fScoringWorld->GetNx(); sy = fScoringWorld->GetNy(); sz = fScoringWorld->GetNz();
+	} else {
+		sx = nx; sy = ny; sz = nz;
+	}
+}
+
+G4double DetectorConstruction::GetScoringVoxelVolume() const {
+	if (fScoringWorld) {
+		const G4ThreeVector& d = fScoringWorld->GetVoxelSize();
+		return d.x()*d.y()*d.z();
+	}
+	return dx*dy*dz;
+}
+
+void DetectorConstruction::BuildImportanceMap() {
+	// requires the phantom to be read and mapped already; otherwise this is called again from Construct()
+	if (matMap.empty()) {
+		return;
+	}
+	fImportanceMap.SetVoxelVolume(pVoxel, !IsNestedPhantom());
+	fImportanceMap.SetSourcePosition(fSourcePos);
+	fImportanceMap.Build(nx, ny, nz, dx, dy, dz, G4ThreeVector(px, py, pz), densVec, matMap);
+
+	std::ofstream outfile;
+	outfile.open("Importance.bin", std::ios::out | std::ios::binary);
+	for (G4long i = 0; i < nxyz; i++) {
+		float val = fImportanceMap.GetImportance(i);
+		outfile.write((char*)(&val), sizeof(float));
+	}
+	outfile.close();
 }
 
 void DetectorConstruction::SanityCheck() {
@@ -279,43 +531,170 @@ void DetectorConstruction::ConstructSDandField() {
 ///////// GENERATE SENSITIVE DETECTORS AND SCORERS ////////////
     G4SDManager *sdmanager = G4SDManager::GetSDMpointer();
 
-    G4MultiFunctionalDetector *mfd = new G4MultiFunctionalDetector("mfd");
-    G4cout << "Attaching Dose MFD of name " << mfd->GetName() << " to SDmanager" << G4endl;
-    sdmanager->AddNewDetector(mfd);
-    SetSensitiveDetector("lRepX", mfd);
+    // after a geometry reload the detector (and its hits collections) already exists on this thread; only the
+    // voxel-indexed primitives are rebuilt for the new phantom dimensions
+    G4MultiFunctionalDetector *mfd;
+    if (fFusedScoring) {
+        mfd = CreateFusedDetector();
+    } else {
+        mfd = static_cast<G4MultiFunctionalDetector*>(sdmanager->FindSensitiveDetector("mfd", false));
+        if (!mfd) {
+            mfd = new G4MultiFunctionalDetector("mfd");
+            G4cout << "Attaching Dose MFD of name " << mfd->GetName() << " to SDmanager" << G4endl;
+            sdmanager->AddNewDetector(mfd);
+        } else {
+            while (mfd->GetNumberOfPrimitives() > 0) {
+                G4VPrimitiveScorer* old = mfd->GetPrimitive(0);
+                mfd->RemovePrimitive(old);
+                delete old;
+            }
+        }
+        CreateScorers(mfd);
+        if (fKermaScoring) {
+            G4cerr << "Warning: kerma (kerma3d) is only scored by the fused detector (/det/scorer/fused true)" << G4endl;
+        }
+        if (fHistoryUncertainty) {
+            G4cerr << "Warning: the per-history sums of squares (*_sq) are only scored by the fused detector (/det/scorer/fused true)" << G4endl;
+        }
+    }
+    G4String voxelVolume = fScoringWorld ? "lMeshX" : (IsNestedPhantom() ? "lRepX" : "lVoxel");
+    SetSensitiveDetector(voxelVolume, mfd);
+    if (!fScoringWorld && !IsNestedPhantom()) {
+        if (fPhantomType == "regularSkip") {
+            G4cerr << "Warning: steps through voxels of equal material are scored in their first voxel with"
+                " /det/phantomType regularSkip; meant for navigation benchmarks (bench/navigation.sh)" << G4endl;
+        }
+    }
+
+    // photon spectra are kept in sparse per-run storage rather than hits maps, so they have their own detector
+    if (fSpectrumBinning.nbins > 0) {
+        SpectralFluenceSD* spectral = static_cast<SpectralFluenceSD*>(sdmanager->FindSensitiveDetector("photonSpectrum", false));
+        if (!spectral) {
+            spectral = new SpectralFluenceSD("photonSpectrum");
+            sdmanager->AddNewDetector(spectral);
+        }
+        G4int sx, sy, sz;
+        GetScoringGrid(sx, sy, sz);
+        spectral->SetGrid(sx, sy, sz, &fRoi, !fScoringWorld && !IsNestedPhantom());
+        SetSensitiveDetector(voxelVolume, spectral);
+    }
+
+    // fast simulation models are thread-local and must be created here
+    const PhysicsList* physics = static_cast<const PhysicsList*>(G4RunManager::GetRunManager()->GetUserPhysicsList());
+    if (physics && physics->IsWoodcockEnabled()) {
+        G4Region* phantomRegion = G4RegionStore::GetInstance()->GetRegion("phantom");
+        static G4ThreadLocal WoodcockModel* woodcock = 0;
+        if (!woodcock) {
+            woodcock = new WoodcockModel("woodcock", phantomRegion, nx, ny, nz, dx, dy, dz, matMap, matVec);
+            G4cout << "Attaching Woodcock photon tracking to region " << phantomRegion->GetName() << G4endl;
+        } else {
+            woodcock->SetPhantom(nx, ny, nz, dx, dy, dz);
+        }
+    }
+}
+
+G4MultiFunctionalDetector* DetectorConstruction::CreateFusedDetector() {
+    G4SDManager *sdmanager = G4SDManager::GetSDMpointer();
+    DoseDetector* fused = static_cast<DoseDetector*>(sdmanager->FindSensitiveDetector("mfd", false));
+    if (!fused) {
+        fused = new DoseDetector("mfd");
+        G4cout << "Attaching fused Dose MFD of name " << fused->GetName() << " to SDmanager" << G4endl;
+        sdmanager->AddNewDetector(fused);
+    } else {
+        fused->DetachAll();
+    }
+
+    G4int sx, sy, sz;
+    GetScoringGrid(sx, sy, sz);
+    fused->SetGrid(sx, sy, sz, GetScoringVoxelVolume(), &fRoi, !fScoringWorld && !IsNestedPhantom());
+
+    fused->Attach<0>("dose3d")->SetHistoryTally(true);
+    fused->Attach<1>("photonFluence")->SetHistoryTally(true);
+    if (fDirectionalDose) {
+        fused->Attach<2>("fedose3d");
+        fused->Attach<3>("bedose3d");
+    }
+    if (fTrackLengthFluence) {
+        fused->Attach<4>("photonFluenceTL")->SetHistoryTally(true);
+        fused->Attach<5>("electronFluenceTL")->SetHistoryTally(true);
+    }
+    if (fKermaScoring) {
+        fused->Attach<6>("kerma3d");
+        fused->GetChannel<6>().quantity.table = &fKermaTable;
+    }
+    for (G4int i = 0; i < fused->GetNumberOfPrimitives(); ++i) {
+        G4cout << "Attaching fused scorer channel of name " << fused->GetPrimitive(i)->GetName() << " to mfd" << G4endl;
+    }
+    return fused;
+}
+
+void DetectorConstruction::CreateScorers(G4MultiFunctionalDetector* mfd) {
+    // voxels of the scoring grid (phantom or parallel world mesh)
+    G4int nx, ny, nz;
+    GetScoringGrid(nx, ny, nz);
 
     // create filters
-    G4SDParticleFilter* gammaFilter = new G4SDParticleFilter("gammaFilter", "gamma");
-    gammaFilter->show();
+    static G4ThreadLocal G4SDParticleFilter* gammaFilter = 0;
+    if (!gammaFilter) {
+        gammaFilter = new G4SDParticleFilter("gammaFilter", "gamma");
+        gammaFilter->show();
+    }
 
-    // std::vector<G4String> electronpositron = {"e-", "e+"};
-    // G4SDParticleFilter* electronFilter = new G4SDParticleFilter("electronFilter", electronpositron);
-    // electronFilter->add("e+");
-    // electronFilter->show();
+    std::vector<G4String> electronpositron = {"e-", "e+"};
+    static G4ThreadLocal G4SDParticleFilter* electronFilter = 0;
+    if (fTrackLengthFluence && !electronFilter) {
+        electronFilter = new G4SDParticleFilter("electronFilter", electronpositron);
+        electronFilter->show();
+    }
 
-    // G4UserParticleWithDirectionFilter* forwardElectronFilter = new G4UserParticleWithDirectionFilter("forwardElectronFilter", electronpositron, G4ThreeVector(0,0,1) );
-    // forwardElectronFilter->show();
-    // G4UserParticleWithDirectionFilter* backwardElectronFilter = new G4UserParticleWithDirectionFilter("backwardElectronFilter", electronpositron, G4ThreeVector(0,0,-1));
-    // backwardElectronFilter->show();
+    static G4ThreadLocal G4UserParticleWithDirectionFilter* forwardElectronFilter = 0;
+    static G4ThreadLocal G4UserParticleWithDirectionFilter* backwardElectronFilter = 0;
+    if (fDirectionalDose && !forwardElectronFilter) {
+        forwardElectronFilter = new G4UserParticleWithDirectionFilter("forwardElectronFilter", electronpositron, G4ThreeVector(0,0,1) );
+        forwardElectronFilter->show();
+        backwardElectronFilter = new G4UserParticleWithDirectionFilter("backwardElectronFilter", electronpositron, G4ThreeVector(0,0,-1));
+        backwardElectronFilter->show();
+    }
 
 
     // total dose
     // don't forget to set depi/j/k to 0,1,2 for ZYX ordering
-    G4PSDoseDeposit3D* dose3d = new G4PSDoseDeposit3D("dose3d", nz, ny, nx);
+    // with a region of interest, voxels are indexed in the compact ROI grid instead of the full phantom, and in the
+    // regular phantom by the voxel copy number instead of the replica numbers, both through RoiScorer
+    G4bool flatIndex = !fScoringWorld && !IsNestedPhantom();
+    G4bool wrap = fRoi.IsEnabled() || flatIndex;
+    G4PSDoseDeposit3D* dose3d;
+    if (wrap) {
+        dose3d = new RoiScorer<G4PSDoseDeposit3D>("dose3d", nx, ny, nz, &fRoi, flatIndex);
+    } else {
+        dose3d = new G4PSDoseDeposit3D("dose3d", nz, ny, nx);
+    }
     G4cout << "Attaching primitive scorer of name " << dose3d->GetName() << " to mfd" << G4endl;
     mfd->RegisterPrimitive(dose3d);
 
-    // // forward electron dose
-    // G4PSDoseDeposit3D* fedose3d = new G4PSDoseDeposit3D("fedose3d", nx, ny, nz);
-    // fedose3d->SetFilter(forwardElectronFilter);
-    // G4cout << "Attaching primitive scorer of name " << fedose3d->GetName() << " to mfd" << G4endl;
-    // mfd->RegisterPrimitive(fedose3d);
-
-    // // reverse electron dose
-    // G4PSDoseDeposit3D* bedose3d = new G4PSDoseDeposit3D("bedose3d", nx, ny, nz);
-    // bedose3d->SetFilter(backwardElectronFilter);
-    // G4cout << "Attaching primitive scorer of name " << bedose3d->GetName() << " to mfd" << G4endl;
-    // mfd->RegisterPrimitive(bedose3d);
+    if (fDirectionalDose) {
+        // forward electron dose
+        G4PSDoseDeposit3D* fedose3d;
+        if (wrap) {
+            fedose3d = new RoiScorer<G4PSDoseDeposit3D>("fedose3d", nx, ny, nz, &fRoi, flatIndex);
+        } else {
+            fedose3d = new G4PSDoseDeposit3D("fedose3d", nz, ny, nx);
+        }
+        fedose3d->SetFilter(forwardElectronFilter);
+        G4cout << "Attaching primitive scorer of name " << fedose3d->GetName() << " to mfd" << G4endl;
+        mfd->RegisterPrimitive(fedose3d);
+
+        // reverse electron dose
+        G4PSDoseDeposit3D* bedose3d;
+        if (wrap) {
+            bedose3d = new RoiScorer<G4PSDoseDeposit3D>("bedose3d", nx, ny, nz, &fRoi, flatIndex);
+        } else {
+            bedose3d = new G4PSDoseDeposit3D("bedose3d", nz, ny, nx);
+        }
+        bedose3d->SetFilter(backwardElectronFilter);
+        G4cout << "Attaching primitive scorer of name " << bedose3d->GetName() << " to mfd" << G4endl;
+        mfd->RegisterPrimitive(bedose3d);
+    }
 
     // // electron fluence - counts tracks filtered to electrons
     // G4PSPassageCellCurrent3D* electronFluence3D = new G4PSPassageCellCurrent3D("electronFluence", nx, ny, nz);
@@ -324,8 +703,33 @@ void DetectorConstruction::ConstructSDandField() {
     // mfd->RegisterPrimitive(electronFluence3D);
 
     // photon fluence - counts tracks filtered to gammas
-    G4PSPassageCellCurrent3D* photonFluence3D = new G4PSPassageCellCurrent3D("photonFluence", nz, ny, nx);
+    G4PSPassageCellCurrent3D* photonFluence3D;
+    if (wrap) {
+        photonFluence3D = new RoiScorer<G4PSPassageCellCurrent3D>("photonFluence", nx, ny, nz, &fRoi, flatIndex);
+    } else {
+        photonFluence3D = new G4PSPassageCellCurrent3D("photonFluence", nz, ny, nx);
+    }
     photonFluence3D->SetFilter(gammaFilter);
     G4cout << "Attaching primitive scorer of name " << photonFluence3D->GetName() << " to mfd" << G4endl;
     mfd->RegisterPrimitive(photonFluence3D);
+
+    if (fTrackLengthFluence) {
+        // track-length fluence (sum of weighted step lengths per voxel volume) of photons and of electrons/positrons
+        G4PSCellFlux3D* photonFluenceTL;
+        G4PSCellFlux3D* electronFluenceTL;
+        if (wrap) {
+            photonFluenceTL = new RoiScorer<G4PSCellFlux3D>("photonFluenceTL", nx, ny, nz, &fRoi, flatIndex);
+            electronFluenceTL = new RoiScorer<G4PSCellFlux3D>("electronFluenceTL", nx, ny, nz, &fRoi, flatIndex);
+        } else {
+            photonFluenceTL = new G4PSCellFlux3D("photonFluenceTL", nz, ny, nx);
+            electronFluenceTL = new G4PSCellFlux3D("electronFluenceTL", nz, ny, nx);
+        }
+        photonFluenceTL->SetFilter(gammaFilter);
+        electronFluenceTL->SetFilter(electronFilter);
+        G4cout << "Attaching primitive scorer of name " << photonFluenceTL->GetName() << " to mfd" << G4endl;
+        mfd->RegisterPrimitive(photonFluenceTL);
+        G4cout << "Attaching primitive scorer of name " << electronFluenceTL->GetName() << " to mfd" << G4endl;
+        mfd->RegisterPrimitive(electronFluenceTL);
+    }
 }
+
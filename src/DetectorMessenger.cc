@@ -1,5 +1,7 @@
 #include "DetectorMessenger.hh"
 #include "DetectorConstruction.hh"
+#include "ScoringWorld.hh"
+#include "DoseEngine.hh"
 
 #include <sstream>
 
@@ -13,8 +15,8 @@
 #include "G4UIcmdWithoutParameter.hh"
 #include "G4UIcmdWithABool.hh"
 #include "G4RunManager.hh"
-
-extern G4String g_geoFname;
+#include "G4StateManager.hh"
+#include "G4UImanager.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -24,13 +26,249 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction * Det)
   Dir = new G4UIdirectory("/det/");
   Dir->SetGuidance(" Detector control.");
 
-  // geoCmd = new G4UIcmdWithAString("/det/geo", this);
-  // geoCmd->SetGuidance("Set geometry file used in building the detector.");
-  // geoCmd->SetParameterName("geoFile", true);
-  // geoCmd->SetDefaultValue("geo.txt");
+  geoCmd = new G4UIcmdWithAString("/det/geo", this);
+  geoCmd->SetGuidance("Set geometry file used in building the detector.");
+  geoCmd->SetGuidance("Between runs, the phantom is rebuilt from the new file before the next /run/beamOn. Materials with");
+  geoCmd->SetGuidance("  a matching (material, density) pair and their physics tables are reused, as are the scorers.");
+  geoCmd->SetGuidance("Output files are accumulated across runs: move them away before running a different phantom.");
+  geoCmd->SetParameterName("geoFile", false);
+  geoCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  geoCmd->SetToBeBroadcasted(false);
+
+  geoshowCmd = new G4UIcmdWithoutParameter("/det/show",this);
+  geoshowCmd->SetGuidance("List geometry details.");
+  geoshowCmd->SetToBeBroadcasted(false);
+
+  phantomTypeCmd = new G4UIcmdWithAString("/det/phantomType", this);
+  phantomTypeCmd->SetGuidance("Geometry representation of the voxel phantom.");
+  phantomTypeCmd->SetGuidance("  nested:      Z and Y replicas with a nested parameterisation along X (default)");
+  phantomTypeCmd->SetGuidance("  regular:     one G4PhantomParameterisation volume with regular navigation");
+  phantomTypeCmd->SetGuidance("  regularSkip: regular, and steps continue through neighbouring voxels of equal material");
+  phantomTypeCmd->SetGuidance("regularSkip scores a step in its first voxel only and is meant for navigation benchmarks");
+  phantomTypeCmd->SetGuidance("  (bench/navigation.sh).");
+  phantomTypeCmd->SetGuidance("Between runs, the phantom is rebuilt before the next /run/beamOn.");
+  phantomTypeCmd->SetParameterName("type", false);
+  phantomTypeCmd->SetCandidates("nested regular regularSkip");
+  phantomTypeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  phantomTypeCmd->SetToBeBroadcasted(false);
+
+  sourceCmd = new G4UIcmdWith3VectorAndUnit("/det/sourcePosition", this);
+  sourceCmd->SetGuidance("Set the beam source position (default: 0 0 -110 cm). The radiological depth of the importance map");
+  sourceCmd->SetGuidance("  (/det/vr/) is ray-traced from it, and the automatic world (/det/air/autoWorld) encloses it.");
+  sourceCmd->SetParameterName("x", "y", "z", false);
+  sourceCmd->SetDefaultUnit("cm");
+  sourceCmd->SetToBeBroadcasted(false);
+
+  vrDir = new G4UIdirectory("/det/vr/");
+  vrDir->SetGuidance(" Variance reduction from the radiological depth importance map.");
+
+  wwCmd = new G4UIcmdWithABool("/det/vr/weightWindow", this);
+  wwCmd->SetGuidance("Build the importance map and apply photon weight windows (split/roulette) in the phantom.");
+  wwCmd->SetGuidance("  Takes effect at the next beamOn; bench/weightwindow.sh checks that the mean dose is unchanged.");
+  wwCmd->SetParameterName("enable", true);
+  wwCmd->SetDefaultValue(true);
+  wwCmd->SetToBeBroadcasted(false);
+
+  vrMuCmd = new G4UIcmdWithADouble("/det/vr/attenuation", this);
+  vrMuCmd->SetGuidance("Effective attenuation coefficient of the beam in water [1/cm]; importance = exp(mu*depth).");
+  vrMuCmd->SetParameterName("mu", false);
+  vrMuCmd->SetRange("mu>=0");
+  vrMuCmd->SetToBeBroadcasted(false);
+
+  vrMaxImpCmd = new G4UIcmdWithADouble("/det/vr/maxImportance", this);
+  vrMaxImpCmd->SetGuidance("Upper bound of the importance map.");
+  vrMaxImpCmd->SetParameterName("imp", false);
+  vrMaxImpCmd->SetRange("imp>=1");
+  vrMaxImpCmd->SetToBeBroadcasted(false);
+
+  vrRatioCmd = new G4UIcmdWithADouble("/det/vr/windowRatio", this);
+  vrRatioCmd->SetGuidance("Ratio of the upper to the lower weight window bound.");
+  vrRatioCmd->SetParameterName("ratio", false);
+  vrRatioCmd->SetRange("ratio>1");
+  vrRatioCmd->SetToBeBroadcasted(false);
+
+  vrMaxSplitCmd = new G4UIcmdWithAnInteger("/det/vr/maxSplit", this);
+  vrMaxSplitCmd->SetGuidance("Maximum number of copies produced when splitting a photon.");
+  vrMaxSplitCmd->SetParameterName("n", false);
+  vrMaxSplitCmd->SetRange("n>=2");
+  vrMaxSplitCmd->SetToBeBroadcasted(false);
+
+  airDir = new G4UIdirectory("/det/air/");
+  airDir->SetGuidance(" Handling of the air gap between source and phantom.");
+
+  ffCmd = new G4UIcmdWithABool("/det/air/fastForward", this);
+  ffCmd->SetGuidance("Move primary photons along their direction to just outside the phantom entry point.");
+  ffCmd->SetGuidance("Interactions in the air gap are skipped; photons missing the phantom are not moved.");
+  ffCmd->SetParameterName("enable", true);
+  ffCmd->SetDefaultValue(true);
+  ffCmd->SetToBeBroadcasted(false);
+
+  airAttCmd = new G4UIcmdWithABool("/det/air/attenuation", this);
+  airAttCmd->SetGuidance("Weight fast-forwarded photons by exp(-mu_air(E) * skipped distance).");
+  airAttCmd->SetParameterName("enable", true);
+  airAttCmd->SetDefaultValue(true);
+  airAttCmd->SetToBeBroadcasted(false);
+
+  autoWorldCmd = new G4UIcmdWithABool("/det/air/autoWorld", this);
+  autoWorldCmd->SetGuidance("Size the world to enclose the phantom and the source position (default: 30x30x410 cm).");
+  autoWorldCmd->SetParameterName("enable", true);
+  autoWorldCmd->SetDefaultValue(true);
+  autoWorldCmd->AvailableForStates(G4State_PreInit);
+  autoWorldCmd->SetToBeBroadcasted(false);
+
+  roiDir = new G4UIdirectory("/det/roi/");
+  roiDir->SetGuidance(" Restrict the voxel scorers to a region of interest (compact scoring grid).");
+  roiDir->SetGuidance(" Changes after initialization rebuild the geometry and scorers at the next beamOn.");
+
+  roiBoxCmd = new G4UIcommand("/det/roi/box", this);
+  roiBoxCmd->SetGuidance("Score only inside this voxel index box (inclusive bounds).");
+  const char* boxPrmNames[6] = {"ix0", "iy0", "iz0", "ix1", "iy1", "iz1"};
+  for (G4int i=0; i<6; ++i) {
+    G4UIparameter* prm = new G4UIparameter(boxPrmNames[i], 'i', false);
+    prm->SetParameterRange((G4String(boxPrmNames[i]) + ">=0").c_str());
+    roiBoxCmd->SetParameter(prm);
+  }
+  roiBoxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  roiBoxCmd->SetToBeBroadcasted(false);
+
+  roiMaskCmd = new G4UIcmdWithAString("/det/roi/mask", this);
+  roiMaskCmd->SetGuidance("Score only inside this mask: one byte per phantom voxel (ZYX order), nonzero inside.");
+  roiMaskCmd->SetParameterName("maskFile", false);
+  roiMaskCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  roiMaskCmd->SetToBeBroadcasted(false);
+
+  roiMarginCmd = new G4UIcmdWithAnInteger("/det/roi/margin", this);
+  roiMarginCmd->SetGuidance("Grow the box (and dilate the mask) by this many voxels on each side.");
+  roiMarginCmd->SetParameterName("voxels", false);
+  roiMarginCmd->SetRange("voxels>=0");
+  roiMarginCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  roiMarginCmd->SetToBeBroadcasted(false);
 
-  // geoshowCmd = new G4UIcmdWithoutParameter("/det/show",this);
-  // geoshowCmd->SetGuidance("List geometry details.");
+  roiOutputCmd = new G4UIcmdWithAString("/det/roi/output", this);
+  roiOutputCmd->SetGuidance("compact: write the ROI grid only (offset and size in roi.txt);");
+  roiOutputCmd->SetGuidance("expanded: write full phantom volumes, zero outside the ROI.");
+  roiOutputCmd->SetParameterName("mode", false);
+  roiOutputCmd->SetCandidates("compact expanded");
+  roiOutputCmd->SetToBeBroadcasted(false);
+
+  roiClearCmd = new G4UIcmdWithoutParameter("/det/roi/clear", this);
+  roiClearCmd->SetGuidance("Score the full phantom again.");
+  roiClearCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  roiClearCmd->SetToBeBroadcasted(false);
+
+  meshDir = new G4UIdirectory("/det/mesh/");
+  meshDir->SetGuidance(" Score dose on a mesh in a parallel world instead of the CT voxels.");
+  meshDir->SetGuidance(" Any of these commands enables the mesh; /det/roi/ indices then refer to mesh voxels.");
+
+  meshOriginCmd = new G4UIcmdWith3VectorAndUnit("/det/mesh/origin", this);
+  meshOriginCmd->SetGuidance("Lower corner of the scoring mesh (default: lower corner of the phantom).");
+  meshOriginCmd->SetParameterName("x", "y", "z", false);
+  meshOriginCmd->SetDefaultUnit("mm");
+  meshOriginCmd->AvailableForStates(G4State_PreInit);
+  meshOriginCmd->SetToBeBroadcasted(false);
+
+  meshExtentCmd = new G4UIcmdWith3VectorAndUnit("/det/mesh/extent", this);
+  meshExtentCmd->SetGuidance("Size of the scoring mesh (default: size of the phantom).");
+  meshExtentCmd->SetParameterName("x", "y", "z", false);
+  meshExtentCmd->SetDefaultUnit("mm");
+  meshExtentCmd->AvailableForStates(G4State_PreInit);
+  meshExtentCmd->SetToBeBroadcasted(false);
+
+  meshVoxelCmd = new G4UIcmdWith3VectorAndUnit("/det/mesh/voxelSize", this);
+  meshVoxelCmd->SetGuidance("Voxel size of the scoring mesh (default: 2.5 mm); rounded so that the extent is covered exactly.");
+  meshVoxelCmd->SetParameterName("dx", "dy", "dz", false);
+  meshVoxelCmd->SetDefaultUnit("mm");
+  meshVoxelCmd->AvailableForStates(G4State_PreInit);
+  meshVoxelCmd->SetToBeBroadcasted(false);
+
+  scorerDir = new G4UIdirectory("/det/scorer/");
+  scorerDir->SetGuidance(" Voxel scorer setup.");
+
+  fusedCmd = new G4UIcmdWithABool("/det/scorer/fused", this);
+  fusedCmd->SetGuidance("Score all quantities in a single per-step callback instead of one Geant4 primitive scorer (with");
+  fusedCmd->SetGuidance("  its own filter) per quantity (default). Needed for kerma3d and the *_sq outputs;");
+  fusedCmd->SetGuidance("  compare with bench/fused.sh.");
+  fusedCmd->SetParameterName("enable", true);
+  fusedCmd->SetDefaultValue(true);
+  fusedCmd->AvailableForStates(G4State_PreInit);
+  fusedCmd->SetToBeBroadcasted(false);
+
+  directionalCmd = new G4UIcmdWithABool("/det/scorer/directionalDose", this);
+  directionalCmd->SetGuidance("Also score electron/positron dose split by direction along z (fedose3d, bedose3d).");
+  directionalCmd->SetParameterName("enable", true);
+  directionalCmd->SetDefaultValue(true);
+  directionalCmd->AvailableForStates(G4State_PreInit);
+  directionalCmd->SetToBeBroadcasted(false);
+
+  trackLengthCmd = new G4UIcmdWithABool("/det/scorer/trackLengthFluence", this);
+  trackLengthCmd->SetGuidance("Also score photon and electron/positron fluence as weighted track length per voxel volume");
+  trackLengthCmd->SetGuidance("  (photonFluenceTL, electronFluenceTL; 1/mm2). Lower variance than the passage count of photonFluence.");
+  trackLengthCmd->SetGuidance("Woodcock photon steps (/phys/woodcock) cross voxels, so photonFluenceTL needs voxel stepping.");
+  trackLengthCmd->SetParameterName("enable", true);
+  trackLengthCmd->SetDefaultValue(true);
+  trackLengthCmd->AvailableForStates(G4State_PreInit);
+  trackLengthCmd->SetToBeBroadcasted(false);
+
+  kermaCmd = new G4UIcmdWithABool("/det/scorer/kerma", this);
+  kermaCmd->SetGuidance("Fast kerma mode for the following runs: photon track length times mu_tr/rho of the voxel");
+  kermaCmd->SetGuidance("  material is scored as kerma3d (Gy), and secondary electrons and positrons are killed.");
+  kermaCmd->SetGuidance("This is total kerma (mu_tr, no radiative yield correction); it approximates dose away from interfaces");
+  kermaCmd->SetGuidance("  and beyond the buildup region. dose3d (and dose3d_sq) is not written in kerma runs, so it only");
+  kermaCmd->SetGuidance("  accumulates full transport runs. Not compatible with /phys/woodcock.");
+  kermaCmd->SetGuidance("Enabling it for the first time after initialization rebuilds the scorers at the next beamOn.");
+  kermaCmd->SetParameterName("enable", true);
+  kermaCmd->SetDefaultValue(true);
+  kermaCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  kermaCmd->SetToBeBroadcasted(false);
+
+  historiesCmd = new G4UIcmdWithAnInteger("/det/scorer/historiesPerEvent", this);
+  historiesCmd->SetGuidance("Generate this many independent primaries (histories) in every event (default: 1), so that the");
+  historiesCmd->SetGuidance("  per-event overhead is paid once per K histories. /run/beamOn counts events: N events are N*K histories.");
+  historiesCmd->SetGuidance("Tracked beamlet outputs need one primary per event and are skipped otherwise.");
+  historiesCmd->SetParameterName("K", false);
+  historiesCmd->SetRange("K>=1");
+  historiesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  historiesCmd->SetToBeBroadcasted(false);
+
+  uncertaintyCmd = new G4UIcmdWithABool("/det/scorer/uncertainty", this);
+  uncertaintyCmd->SetGuidance("Score the sum over histories of the squared dose and fluence of each history (dose3d_sq,");
+  uncertaintyCmd->SetGuidance("  photonFluence_sq, and photonFluenceTL_sq, electronFluenceTL_sq with /det/scorer/trackLengthFluence),");
+  uncertaintyCmd->SetGuidance("  and count the histories (histories.txt), for the statistical uncertainty of these outputs");
+  uncertaintyCmd->SetGuidance("  (see bench/regression.sh and bench/fluence_variance.sh). Histories are followed");
+  uncertaintyCmd->SetGuidance("  through their tracks, so the estimate is per history also with several histories per event.");
+  uncertaintyCmd->SetParameterName("enable", true);
+  uncertaintyCmd->SetDefaultValue(true);
+  uncertaintyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  uncertaintyCmd->SetToBeBroadcasted(false);
+
+  spectrumDir = new G4UIdirectory("/det/spectrum/");
+  spectrumDir->SetGuidance(" Per-voxel photon fluence spectra (photonSpectrum), stored only for voxels that are hit.");
+  spectrumDir->SetGuidance(" Changes after initialization rebuild the geometry and scorers at the next beamOn.");
+
+  spectrumBinsCmd = new G4UIcommand("/det/spectrum/bins", this);
+  spectrumBinsCmd->SetGuidance("Energy binning of the spectra; 0 bins disables spectral scoring (default).");
+  G4UIparameter* nbinsPrm = new G4UIparameter("nbins", 'i', false);
+  nbinsPrm->SetParameterRange("nbins>=0");
+  spectrumBinsCmd->SetParameter(nbinsPrm);
+  spectrumBinsCmd->SetParameter(new G4UIparameter("emin", 'd', true));
+  spectrumBinsCmd->SetParameter(new G4UIparameter("emax", 'd', true));
+  G4UIparameter* unitPrm = new G4UIparameter("unit", 's', true);
+  unitPrm->SetDefaultValue("MeV");
+  spectrumBinsCmd->SetParameter(unitPrm);
+  G4UIparameter* scalePrm = new G4UIparameter("scale", 's', true);
+  scalePrm->SetParameterCandidates("lin log");
+  scalePrm->SetDefaultValue("lin");
+  spectrumBinsCmd->SetParameter(scalePrm);
+  spectrumBinsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  spectrumBinsCmd->SetToBeBroadcasted(false);
+
+  spectrumMemCmd = new G4UIcmdWithADouble("/det/spectrum/maxMemory", this);
+  spectrumMemCmd->SetGuidance("Memory limit (MB) of the spectra of each thread (default: 512). Hits in voxels without");
+  spectrumMemCmd->SetGuidance("  a histogram once the limit is reached are dropped and their summed weight reported.");
+  spectrumMemCmd->SetParameterName("MB", false);
+  spectrumMemCmd->SetRange("MB>0");
+  spectrumMemCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  spectrumMemCmd->SetToBeBroadcasted(false);
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -38,22 +276,196 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction * Det)
 DetectorMessenger::~DetectorMessenger()
 {
 	delete   Dir;
-    // delete   geoCmd;
-    // delete   geoshowCmd;
+    delete   geoCmd;
+    delete   geoshowCmd;
+    delete   phantomTypeCmd;
+    delete   wwCmd;
+    delete   vrMuCmd;
+    delete   vrMaxImpCmd;
+    delete   vrRatioCmd;
+    delete   vrMaxSplitCmd;
+    delete   vrDir;
+    delete   ffCmd;
+    delete   airAttCmd;
+    delete   autoWorldCmd;
+    delete   sourceCmd;
+    delete   airDir;
+    delete   roiBoxCmd;
+    delete   roiMaskCmd;
+    delete   roiMarginCmd;
+    delete   roiOutputCmd;
+    delete   roiClearCmd;
+    delete   roiDir;
+    delete   meshOriginCmd;
+    delete   meshExtentCmd;
+    delete   meshVoxelCmd;
+    delete   meshDir;
+    delete   fusedCmd;
+    delete   directionalCmd;
+    delete   trackLengthCmd;
+    delete   kermaCmd;
+    delete   historiesCmd;
+    delete   uncertaintyCmd;
+    delete   scorerDir;
+    delete   spectrumBinsCmd;
+    delete   spectrumMemCmd;
+    delete   spectrumDir;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 void DetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue) {
-    // if (command == geoCmd) {
-    //     g_geoFname = newValue;
-    // } else if (command == geoshowCmd) {
-    //     G4cout << "Geometry file in use is: \"" << g_geoFname << "\""  << G4endl;
-    // }
+    if (command == geoCmd) {
+        DoseEngine::getInstance()->SetGeometryFile(newValue);
+        Detector->fMemoryPhantom = false;
+        G4cout << "Using geometry file: \"" << newValue << "\"" << G4endl;
+        if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+            // Construct() deletes the previous phantom volumes and rebuilds; ConstructSDandField() reattaches the scorers at the next beamOn
+            G4UImanager::GetUIpointer()->ApplyCommand("/run/reinitializeGeometry");
+        }
+        return;
+    } else if (command == geoshowCmd) {
+        if (Detector->HasMemoryPhantom()) {
+            G4cout << "Geometry in use is an in-memory phantom" << G4endl;
+        } else {
+            G4cout << "Geometry file in use is: \"" << DoseEngine::getInstance()->GetGeometryFile() << "\""  << G4endl;
+        }
+        if (Detector->GetConstructCount() > 0) {
+            G4cout << "Array size: " << Detector->nx << " " << Detector->ny << " " << Detector->nz << G4endl <<
+                      "Voxel size (mm): " << Detector->dx << " " << Detector->dy << " " << Detector->dz << G4endl <<
+                      "Center Position (mm): " << Detector->px << " " << Detector->py << " " << Detector->pz << G4endl <<
+                      "Materials: " << Detector->densVec.size() << " in phantom, " << Detector->matCache.size() << " cached" << G4endl;
+        }
+        return;
+    } else if (command == phantomTypeCmd) {
+        Detector->fPhantomType = newValue;
+        if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+            G4UImanager::GetUIpointer()->ApplyCommand("/run/reinitializeGeometry");
+        }
+        return;
+    } else if (command == ffCmd) {
+        Detector->fFastForward = ffCmd->GetNewBoolValue(newValue);
+        return;
+    } else if (command == airAttCmd) {
+        Detector->fAirAttenuation = airAttCmd->GetNewBoolValue(newValue);
+        return;
+    } else if (command == autoWorldCmd) {
+        Detector->fAutoWorld = autoWorldCmd->GetNewBoolValue(newValue);
+        return;
+    } else if (command == meshOriginCmd || command == meshExtentCmd || command == meshVoxelCmd) {
+        Detector->EnableScoringMesh();
+        G4ThreeVector value = G4UIcmdWith3VectorAndUnit::GetNew3VectorValue(newValue);
+        if (command == meshOriginCmd) {
+            Detector->fScoringWorld->SetOrigin(value);
+        } else if (command == meshExtentCmd) {
+            Detector->fScoringWorld->SetExtent(value);
+        } else {
+            Detector->fScoringWorld->SetVoxelSize(value);
+        }
+        return;
+    } else if (command == fusedCmd) {
+        Detector->fFusedScoring = fusedCmd->GetNewBoolValue(newValue);
+        return;
+    } else if (command == directionalCmd) {
+        Detector->fDirectionalDose = directionalCmd->GetNewBoolValue(newValue);
+        return;
+    } else if (command == trackLengthCmd) {
+        Detector->fTrackLengthFluence = trackLengthCmd->GetNewBoolValue(newValue);
+        return;
+    } else if (command == historiesCmd) {
+        Detector->fHistoriesPerEvent = historiesCmd->GetNewIntValue(newValue);
+        return;
+    } else if (command == uncertaintyCmd) {
+        Detector->fHistoryUncertainty = uncertaintyCmd->GetNewBoolValue(newValue);
+        return;
+    } else if (command == kermaCmd) {
+        G4bool enable = kermaCmd->GetNewBoolValue(newValue);
+        Detector->fKermaTable.SetEnabled(enable);
+        // the kerma3d channel stays attached once created, and only scores in runs with kerma mode enabled
+        if (enable && !Detector->fKermaScoring) {
+            Detector->fKermaScoring = true;
+            if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+                G4UImanager::GetUIpointer()->ApplyCommand("/run/reinitializeGeometry");
+            }
+        }
+        return;
+    } else if (command == spectrumBinsCmd || command == spectrumMemCmd) {
+        SpectrumBinning& binning = Detector->fSpectrumBinning;
+        if (command == spectrumBinsCmd) {
+            G4int nbins;
+            G4double emin = 0, emax = 0;
+            G4String unit = "MeV", scale = "lin";
+            std::istringstream is(newValue);
+            is >> nbins >> emin >> emax >> unit >> scale;
+            if (nbins > 0 && (emax <= emin || (scale == "log" && emin <= 0))) {
+                G4cerr << "Invalid spectrum energy range [" << emin << ", " << emax << "] " << unit << " (" << scale
+                       << "); spectral scoring unchanged" << G4endl;
+                return;
+            }
+            binning.nbins = nbins;
+            binning.emin = emin*G4UIcommand::ValueOf(unit);
+            binning.emax = emax*G4UIcommand::ValueOf(unit);
+            binning.log = (scale == "log");
+        } else {
+            binning.maxMemoryMB = spectrumMemCmd->GetNewDoubleValue(newValue);
+        }
+        // the spectral detector is attached in ConstructSDandField()
+        if (command == spectrumBinsCmd && G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+            G4UImanager::GetUIpointer()->ApplyCommand("/run/reinitializeGeometry");
+        }
+        return;
+    } else if (command == roiOutputCmd) {
+        Detector->fRoi.SetExpandedOutput(newValue == "expanded");
+        return;
+    } else if (command == roiBoxCmd || command == roiMaskCmd || command == roiMarginCmd || command == roiClearCmd) {
+        if (command == roiBoxCmd) {
+            G4int ix0, iy0, iz0, ix1, iy1, iz1;
+            std::istringstream is(newValue);
+            is >> ix0 >> iy0 >> iz0 >> ix1 >> iy1 >> iz1;
+            Detector->fRoi.SetBox(ix0, iy0, iz0, ix1, iy1, iz1);
+        } else if (command == roiMaskCmd) {
+            Detector->fRoi.SetMaskFile(newValue);
+        } else if (command == roiMarginCmd) {
+            Detector->fRoi.SetMargin(roiMarginCmd->GetNewIntValue(newValue));
+        } else {
+            Detector->fRoi.Clear();
+        }
+        // the ROI is built in Construct() and the scorers in ConstructSDandField()
+        if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+            G4UImanager::GetUIpointer()->ApplyCommand("/run/reinitializeGeometry");
+        }
+        return;
+    }
+
+    ImportanceMap& imap = Detector->GetImportanceMap();
+    if (command == wwCmd) {
+        imap.SetEnabled(wwCmd->GetNewBoolValue(newValue));
+    } else if (command == sourceCmd) {
+        // the world size only follows at the next construction of the geometry
+        Detector->fSourcePos = sourceCmd->GetNew3VectorValue(newValue);
+        imap.Clear();
+    } else if (command == vrMuCmd) {
+        imap.SetAttenuation(vrMuCmd->GetNewDoubleValue(newValue));
+        imap.Clear();
+    } else if (command == vrMaxImpCmd) {
+        imap.SetMaxImportance(vrMaxImpCmd->GetNewDoubleValue(newValue));
+        imap.Clear();
+    } else if (command == vrRatioCmd) {
+        imap.SetWindowRatio(vrRatioCmd->GetNewDoubleValue(newValue));
+    } else if (command == vrMaxSplitCmd) {
+        imap.SetMaxSplit(vrMaxSplitCmd->GetNewIntValue(newValue));
+    }
+
+    // (re)build now if the phantom is already constructed, otherwise this happens in Construct()
+    if (imap.IsEnabled() && !imap.IsBuilt()) {
+        Detector->BuildImportanceMap();
+    }
 }
 G4String DetectorMessenger::GetCurrentValue(G4UIcommand* command) {
-    // if (command == geoCmd) {
-    //     return g_geoFname;
-    // }
+    if (command == geoCmd) {
+        return DoseEngine::getInstance()->GetGeometryFile();
+    } else if (command == phantomTypeCmd) {
+        return Detector->fPhantomType;
+    }
     return G4String("");
 }
@@ -0,0 +1,223 @@
+#include "DoseEngine.hh"
+
+#ifdef G4MULTITHREADED
+    #include "G4MTRunManager.hh"
+    #include "G4Threading.hh"
+    #include "G4Version.hh"
+    #if defined(USE_TASKING) && G4VERSION_NUMBER >= 1070
+        #include "G4TaskRunManager.hh"
+    #endif
+#else
+    #include "G4RunManager.hh"
+#endif
+#include "Randomize.hh"
+#include "G4UImanager.hh"
+#include "G4StateManager.hh"
+
+#include "AllActionInitialization.hh"
+#include "DetectorConstruction.hh"
+#include "PhysicsList.hh"
+#include "PrimaryGeneratorAction.hh" // NUM_THREADS
+#include "WorkerInitialization.hh"
+#include "FocusedRectangleSource.hh"
+#include "G4ParticleTable.hh"
+
+#include <ctime>
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+DoseEngine* DoseEngine::instance = 0;
+
+DoseEngine* DoseEngine::getInstance()
+{
+    if (instance == 0) instance = new DoseEngine();
+    return instance;
+}
+
+DoseEngine::DoseEngine()
+    : fMemoryOutput(false),
+    fEventsProcessed(0), fColdInitTime(0)
+{
+    fGrid[0] = fGrid[1] = fGrid[2] = 0;
+
+	G4cout << "Creating Run Manager ..." << G4endl;
+    #ifdef G4MULTITHREADED
+        #if defined(USE_TASKING) && G4VERSION_NUMBER >= 1070
+            // events are submitted as tasks to a thread pool; idle threads pick up the remaining event bunches
+            G4cout << "Running multithreaded (tasking)." << G4endl;
+            G4MTRunManager *runManager = new G4TaskRunManager{};
+        #else
+            #ifdef USE_TASKING
+                G4cout << "Tasking requires Geant4 10.7 or later; using the MT run manager" << G4endl;
+            #endif
+            G4cout << "Running multithreaded." << G4endl;
+            G4MTRunManager *runManager = new G4MTRunManager{};
+        #endif
+
+        // enable run-level seeding (instead of event-level seeding) in MT;
+        // recommended for high event-count runs (like all medical physics dose calculation)
+        runManager->SetSeedOncePerCommunication(1);
+        G4cout << "Using MT seeding strategy: ";
+        switch (runManager->SeedOncePerCommunication()) {
+            case 0 :
+                G4cout << "event-level" << G4endl
+                    << " (warning: event-level seeding is unsuitable for high-run-count simulation, prefer run-level instead)";
+                break;
+            case 1 :
+                G4cout << "run-level";
+                break;
+            default :
+                G4cout << runManager->SeedOncePerCommunication();
+        }
+        G4cout << G4endl;
+        #ifdef USEPHASESPACE
+            // set NUM_THREADS in PrimaryGeneratorAction.hh
+            G4int number_of_cores = G4Threading::G4GetNumberOfCores();
+            number_of_cores = NUM_THREADS;
+            G4cout << "Number of cores/threads in use: "
+                << number_of_cores << " of "
+                << G4Threading::G4GetNumberOfCores()
+                << G4endl;
+            runManager->SetNumberOfThreads(number_of_cores);
+        #endif
+    #else
+        G4cout << "Running single threaded." << G4endl;
+		G4RunManager* runManager = new G4RunManager;
+    #endif
+    fRunManager = runManager;
+
+    // prng seed
+    G4int seed = time(NULL)%900000000; // prevents seed overflow
+    // G4Random::setTheEngine(new CLHEP::Ranlux64Engine());
+    // G4Random::setTheEngine(new CLHEP::MTwistEngine()); // uses two seeds
+    auto *engine = G4Random::getTheEngine();
+    G4Random::setTheSeed(seed);
+    G4cout << "Psuedo-RNG seed: " << seed << G4endl;
+    engine->showStatus();
+
+
+    /*------------------ Mandatory Init Classes ---------------------------------------*/
+    // Geometry - construct
+    DetectorConstruction* det = DetectorConstruction::getInstance();
+    runManager->SetUserInitialization(det);
+
+    // Physics - register instance of selected physics with runManager
+    G4VModularPhysicsList* physics = new PhysicsList;
+    runManager->SetUserInitialization(physics);
+
+    // Register all "UserActions": Particle generation, Stepping Actions, Event Actions ... etc
+    G4VUserActionInitialization* AAI = new AllActionInitialization();
+    runManager->SetUserInitialization(AAI);
+
+    #ifdef G4MULTITHREADED
+        // optional pinning of worker threads (/mt/pinning)
+        runManager->SetUserInitialization(new WorkerInitialization());
+    #endif
+
+    // shared by all threads; created here so that its /rect/ commands exist on the master
+    FocusedRectangleSource::getInstance();
+    /*---------------------------------------------------------------------------------*/
+}
+
+DoseEngine::~DoseEngine()
+{
+    delete fRunManager;
+    instance = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void DoseEngine::SetPhantomFile(const G4String& fname)
+{
+    if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_PreInit) {
+        fGeoFname = fname;
+        G4cout << "Using geometry file: \"" << fGeoFname << "\"" << G4endl;
+    } else {
+        Apply("/det/geo " + fname);
+    }
+}
+
+void DoseEngine::SetPhantom(const PhantomSpec& spec)
+{
+    DetectorConstruction::getInstance()->SetPhantom(spec);
+    if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+        Apply("/run/reinitializeGeometry");
+    }
+}
+
+void DoseEngine::SetSource(const SourceSpec& source)
+{
+    FocusedRectangleSource* rect = FocusedRectangleSource::getInstance();
+    G4ParticleDefinition* particle = G4ParticleTable::GetParticleTable()->FindParticle(source.particle);
+    if (!particle) {
+        G4cerr << "DoseEngine: particle \"" << source.particle << "\" not found" << G4endl;
+        return;
+    }
+    rect->SetParticle(particle);
+    rect->SetCentre(source.center);
+    rect->SetHalfX(source.halfx);
+    rect->SetHalfY(source.halfy);
+    rect->SetFocusPoint(source.focus);
+    if (source.energy > 0) {
+        rect->SetMonoEnergy(source.energy);
+    } else if (!rect->ReadSpectrum(source.spectrumFile)) {
+        return;
+    }
+    rect->SetEnabled(true);
+}
+
+G4int DoseEngine::Apply(const G4String& command)
+{
+    G4int status = G4UImanager::GetUIpointer()->ApplyCommand(command);
+    if (status != 0) {
+        G4cerr << "DoseEngine: command \"" << command << "\" failed (" << status << ")" << G4endl;
+    }
+    return status;
+}
+
+G4long DoseEngine::BeamOn(G4long nevents)
+{
+    if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_PreInit) {
+        fRunManager->Initialize();
+    }
+    G4long before = fEventsProcessed;
+    fRunManager->BeamOn(nevents);
+    return fEventsProcessed - before;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+Span<const G4double> DoseEngine::GetOutput(const G4String& quantity) const
+{
+    auto it = fOutputs.find(quantity);
+    if (it == fOutputs.end()) { return Span<const G4double>(); }
+    return Span<const G4double>(it->second);
+}
+
+void DoseEngine::GetOutputGrid(G4int& nx, G4int& ny, G4int& nz) const
+{
+    nx = fGrid[0]; ny = fGrid[1]; nz = fGrid[2];
+}
+
+void DoseEngine::ResetOutput()
+{
+    for (auto& it : fOutputs) {
+        std::fill(it.second.begin(), it.second.end(), 0.);
+    }
+}
+
+std::vector<G4double>& DoseEngine::OutputBuffer(const G4String& name, G4int nx, G4int ny, G4int nz)
+{
+    std::vector<G4double>& buffer = fOutputs[name];
+    G4long size = (G4long)nx*ny*nz;
+    if ((G4long)buffer.size() != size) {
+        // left over from a phantom of a different size (see /det/geo)
+        if (!buffer.empty()) {
+            G4cerr << "Warning: in-memory output \"" << name << "\" does not match the scoring grid and is reset" << G4endl;
+        }
+        buffer.assign(size, 0.);
+    }
+    fGrid[0] = nx; fGrid[1] = ny; fGrid[2] = nz;
+    return buffer;
+}
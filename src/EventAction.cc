@@ -1,16 +1,32 @@
 #include "EventAction.hh"
 
 #include "G4Event.hh"
+#include "G4Threading.hh"
+#include "G4RunManager.hh"
+
+#include "ProgressReporter.hh"
+#include "Checkpoint.hh"
+#include "HistoryTally.hh"
+#include "DetectorConstruction.hh"
 
 void EventAction::BeginOfEventAction(const G4Event* event) {
     // perform actions before the primary tracks begin tracking
     // G4Event contains the list of primary vertices and particles
 
+    // history IDs of this event for the per-history dose tally
+    HistoryTally::BeginEvent(event->GetEventID(), DetectorConstruction::getInstance()->GetHistoriesPerEvent());
 }
 
 void EventAction::EndOfEventAction(const G4Event* event) {
     // Perform actions after event has completed (all tracks associated with the primary particle have left the event's stack)
     // The G4Event input has a list of primary vertices and particles and collections of hits and trajectories
 
+    ProgressReporter::getInstance()->EventDone(G4Threading::G4GetThreadId());
+
+    // checkpoint due or stop signal: end this thread's event loop after the current event; the run is then merged and
+    // written as usual and the missing events are run after the checkpoint (or after the restart)
+    if (Checkpoint::getInstance()->InterruptRequested()) {
+        G4RunManager::GetRunManager()->AbortRun(true);
+    }
 }
 
@@ -0,0 +1,192 @@
+#include "FocusedRectangleSource.hh"
+#include "RectSourceMessenger.hh"
+
+#include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4Gamma.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+FocusedRectangleSource* FocusedRectangleSource::instance = 0;
+
+FocusedRectangleSource* FocusedRectangleSource::getInstance()
+{
+    if (instance == 0) instance = new FocusedRectangleSource();
+    return instance;
+}
+
+// defaults of the GPS
+FocusedRectangleSource::FocusedRectangleSource()
+    : fEnabled(false),
+    fParticle(G4Gamma::Definition()),
+    fCentre(0, 0, 0),
+    fRot1(1, 0, 0), fRot2(0, 1, 0),
+    fHalfX(0), fHalfY(0),
+    fFocus(0, 0, 0),
+    fMonoEnergy(1*MeV)
+{
+    UpdateAxes();
+    fMessenger = new RectSourceMessenger(this);
+}
+
+FocusedRectangleSource::~FocusedRectangleSource()
+{
+    delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FocusedRectangleSource::UpdateAxes()
+{
+    fAxisX = fRot1.unit();
+    G4ThreeVector axisZ = fRot1.cross(fRot2).unit();
+    fAxisY = axisZ.cross(fAxisX).unit();
+}
+
+void FocusedRectangleSource::SetMonoEnergy(G4double ekin)
+{
+    fMonoEnergy = ekin;
+    fEnergy.clear();
+    fUpper.clear();
+    fAliasProb.clear();
+    fAlias.clear();
+}
+
+G4bool FocusedRectangleSource::SetSpectrum(const std::vector<G4double>& energies, const std::vector<G4double>& weights)
+{
+    G4int npoints = energies.size();
+    if (npoints < 2 || (G4int)weights.size() != npoints) {
+        G4cerr << "Error: a spectrum needs at least two (energy, density) points" << G4endl;
+        return false;
+    }
+
+    // probability of each segment: area of the trapezoid under the linear density
+    G4int nseg = npoints-1;
+    std::vector<G4double> area(nseg);
+    G4double total = 0;
+    for (G4int i=0; i<nseg; ++i) {
+        if (energies[i+1] <= energies[i] || weights[i] < 0 || weights[i+1] < 0) {
+            G4cerr << "Error: spectrum energies must increase and densities must not be negative" << G4endl;
+            return false;
+        }
+        area[i] = 0.5*(weights[i] + weights[i+1])*(energies[i+1] - energies[i]);
+        total += area[i];
+    }
+    if (total <= 0) {
+        G4cerr << "Error: spectrum is empty" << G4endl;
+        return false;
+    }
+
+    // the linear density on a segment is the mixture of a falling and a rising triangle, weighted by the end points
+    fEnergy = energies;
+    fUpper.resize(nseg);
+    for (G4int i=0; i<nseg; ++i) {
+        G4double sum = weights[i] + weights[i+1];
+        fUpper[i] = sum > 0 ? weights[i+1]/sum : 0.5;
+    }
+
+    // alias table (Vose): segment k is kept with probability fAliasProb[k], otherwise fAlias[k] is used
+    fAliasProb.assign(nseg, 1.);
+    fAlias.resize(nseg);
+    std::vector<G4double> scaled(nseg);
+    std::vector<G4int> small, large;
+    for (G4int i=0; i<nseg; ++i) {
+        fAlias[i] = i;
+        scaled[i] = area[i]*nseg/total;
+        (scaled[i] < 1. ? small : large).push_back(i);
+    }
+    while (!small.empty() && !large.empty()) {
+        G4int s = small.back(); small.pop_back();
+        G4int l = large.back(); large.pop_back();
+        fAliasProb[s] = scaled[s];
+        fAlias[s] = l;
+        scaled[l] -= 1. - scaled[s];
+        (scaled[l] < 1. ? small : large).push_back(l);
+    }
+    // leftovers are 1 up to rounding
+    for (G4int i : small) { fAliasProb[i] = 1.; }
+    for (G4int i : large) { fAliasProb[i] = 1.; }
+    return true;
+}
+
+G4bool FocusedRectangleSource::ReadSpectrum(const G4String& fname)
+{
+    std::ifstream infile(fname);
+    if (!infile.good()) {
+        G4cerr << "Error opening spectrum file \"" << fname << "\"" << G4endl;
+        return false;
+    }
+    std::vector<G4double> energies, weights;
+    std::string line;
+    while (std::getline(infile, line)) {
+        std::istringstream ss(line);
+        G4double e, w;
+        if (ss >> e >> w) {
+            energies.push_back(e*MeV);
+            weights.push_back(w);
+        }
+    }
+    G4bool ok = SetSpectrum(energies, weights);
+    if (ok) {
+        G4cout << "Rectangle source: " << energies.size() << " spectrum points from \"" << fname << "\"" << G4endl;
+    }
+    return ok;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double FocusedRectangleSource::SampleEnergy() const
+{
+    if (fAlias.empty()) { return fMonoEnergy; }
+
+    G4int nseg = fAlias.size();
+    G4double u = G4UniformRand()*nseg;
+    G4int k = std::min(nseg-1, (G4int)u);
+    G4int seg = (u - k < fAliasProb[k]) ? k : fAlias[k];
+
+    // rising triangle: max of two uniforms, falling triangle: min of two uniforms
+    G4double u1 = G4UniformRand();
+    G4double u2 = G4UniformRand();
+    G4double t = (G4UniformRand() < fUpper[seg]) ? std::max(u1, u2) : std::min(u1, u2);
+    return fEnergy[seg] + t*(fEnergy[seg+1] - fEnergy[seg]);
+}
+
+void FocusedRectangleSource::GeneratePrimaryVertex(G4Event* anEvent)
+{
+    G4double x = fHalfX*(2.*G4UniformRand() - 1.);
+    G4double y = fHalfY*(2.*G4UniformRand() - 1.);
+    G4ThreeVector pos = fCentre + x*fAxisX + y*fAxisY;
+
+    G4PrimaryParticle* particle = new G4PrimaryParticle(fParticle);
+    particle->SetKineticEnergy(SampleEnergy());
+    particle->SetMomentumDirection((fFocus - pos).unit());
+
+    G4PrimaryVertex* vertex = new G4PrimaryVertex(pos, 0.);
+    vertex->SetPrimary(particle);
+    anEvent->AddPrimaryVertex(vertex);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void FocusedRectangleSource::Print() const
+{
+    G4cout << "Rectangle source (" << (fEnabled ? "enabled" : "disabled") << "):" << G4endl <<
+              "  Particle: " << fParticle->GetParticleName() << G4endl <<
+              "  Centre (mm): " << fCentre/mm << G4endl <<
+              "  Half size (mm): " << fHalfX/mm << " " << fHalfY/mm << " along " << fAxisX << ", " << fAxisY << G4endl <<
+              "  Focus point (mm): " << fFocus/mm << G4endl;
+    if (fAlias.empty()) {
+        G4cout << "  Energy (MeV): " << fMonoEnergy/MeV << G4endl;
+    } else {
+        G4cout << "  Spectrum (MeV): " << fEnergy.size() << " points in [" << fEnergy.front()/MeV << ", "
+            << fEnergy.back()/MeV << "], linear interpolation" << G4endl;
+    }
+}
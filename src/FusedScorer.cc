@@ -0,0 +1,27 @@
+#include "FusedScorer.hh"
+
+#include "G4HCofThisEvent.hh"
+#include "G4RunManager.hh"
+
+#include "Run.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScoreChannel::Initialize(G4HCofThisEvent* HCE)
+{
+    fEvtMap = new G4THitsMap<G4double>(GetMultiFunctionalDetector()->GetName(), GetName());
+    if (fHCID < 0) { fHCID = GetCollectionID(0); }
+    HCE->AddHitsCollection(fHCID, fEvtMap);
+
+    fTally = 0;
+    Run* run = static_cast<Run*>(G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+    if (fHistories && run) {
+        auto it = run->history_tallies.find(GetName());
+        if (it != run->history_tallies.end() && it->second.IsEnabled()) { fTally = &it->second; }
+    }
+}
+
+void ScoreChannel::clear()
+{
+    fEvtMap->clear();
+}
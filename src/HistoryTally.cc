@@ -0,0 +1,38 @@
+#include "HistoryTally.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal G4long HistoryTally::sEventBase = 0;
+G4ThreadLocal G4long HistoryTally::sHistory = 0;
+
+void HistoryTally::Configure(G4long nvoxels)
+{
+    fSum2.assign(nvoxels, 0.);
+    fTemp.clear();
+    fHistory = -1;
+}
+
+void HistoryTally::Flush()
+{
+    for (const auto& voxel : fTemp) {
+        fSum2[voxel.first] += voxel.second*voxel.second;
+    }
+    fTemp.clear();
+}
+
+void HistoryTally::Merge(const HistoryTally& other)
+{
+    if (other.fSum2.size() != fSum2.size()) { return; }
+    for (size_t i=0; i<fSum2.size(); ++i) {
+        fSum2[i] += other.fSum2[i];
+    }
+    for (const auto& voxel : other.fTemp) {
+        fSum2[voxel.first] += voxel.second*voxel.second;
+    }
+}
+
+void HistoryTally::Finish()
+{
+    Flush();
+    fHistory = -1;
+}
@@ -0,0 +1,148 @@
+#include "ImportanceMap.hh"
+
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4Track.hh"
+#include "G4ParticleChange.hh"
+#include "G4DynamicParticle.hh"
+#include "G4VTouchable.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Gamma.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+#include <cfloat>
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ImportanceMap::ImportanceMap()
+    : fEnabled(false),
+    fSourcePos(0, 0, -100*cm),
+    fMu(0.05),
+    fMaxImportance(64.),
+    fWindowRatio(4.),
+    fMaxSplit(10),
+    fVoxelVolume(0),
+    fFlatIndex(false),
+    fNx(0), fNy(0), fNz(0)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ImportanceMap::Clear() {
+    fRadDepth.clear();
+    fImportance.clear();
+}
+
+void ImportanceMap::Build(G4int nx, G4int ny, G4int nz, G4double dx, G4double dy, G4double dz, const G4ThreeVector& center,
+        const std::vector<G4double>& densVec, const std::vector<G4int>& matMap)
+{
+    fNx = nx; fNy = ny; fNz = nz;
+    G4long nxyz = (G4long)nx*ny*nz;
+    fRadDepth.assign(nxyz, 0.f);
+    fImportance.assign(nxyz, 1.f);
+
+    // phantom bounds (global coords)
+    G4ThreeVector half(nx*dx/2., ny*dy/2., nz*dz/2.);
+    G4ThreeVector lo = center - half;
+    G4ThreeVector hi = center + half;
+    G4double h = 0.5*std::min(dx, std::min(dy, dz)); // ray marching step length
+
+    G4double dmin = DBL_MAX;
+    G4double dmax = 0;
+    for (G4int iz=0; iz<nz; ++iz) {
+        for (G4int iy=0; iy<ny; ++iy) {
+            for (G4int ix=0; ix<nx; ++ix) {
+                G4long idx = iz*ny*nx + iy*nx + ix; // ZYX ordering
+                G4ThreeVector target = lo + G4ThreeVector((ix+0.5)*dx, (iy+0.5)*dy, (iz+0.5)*dz);
+                G4ThreeVector ray = target - fSourcePos;
+                G4double len = ray.mag();
+
+                // parametric entry point of the source->target segment into the phantom box (slab method)
+                G4double tin = 0;
+                for (G4int ax=0; ax<3; ++ax) {
+                    if (std::fabs(ray[ax]) < 1e-12) { continue; }
+                    G4double t1 = (lo[ax] - fSourcePos[ax])/ray[ax];
+                    G4double t2 = (hi[ax] - fSourcePos[ax])/ray[ax];
+                    tin = std::max(tin, std::min(t1, t2));
+                }
+
+                // accumulate density*length along the ray from the phantom surface to the voxel center
+                G4double raddepth = 0;
+                G4double dist = len*(1.-tin);
+                G4int nsteps = std::max(1, (G4int)std::ceil(dist/h));
+                G4double step = dist/nsteps;
+                for (G4int s=0; s<nsteps; ++s) {
+                    G4ThreeVector p = target - ray*((s+0.5)*step/len) - lo;
+                    G4int jx = std::min(nx-1, std::max(0, (G4int)(p.x()/dx)));
+                    G4int jy = std::min(ny-1, std::max(0, (G4int)(p.y()/dy)));
+                    G4int jz = std::min(nz-1, std::max(0, (G4int)(p.z()/dz)));
+                    G4double den = densVec[matMap[jz*ny*nx + jy*nx + jx]]/(g/cm3);
+                    raddepth += den*step/cm;
+                }
+                fRadDepth[idx] = raddepth;
+                dmin = std::min(dmin, raddepth);
+                dmax = std::max(dmax, raddepth);
+            }
+        }
+    }
+
+    // importance relative to the shallowest voxel
+    for (G4long idx=0; idx<nxyz; ++idx) {
+        G4double imp = std::exp(fMu*(fRadDepth[idx] - dmin));
+        fImportance[idx] = std::min(fMaxImportance, std::max(1., imp));
+    }
+
+    G4cout << "Built importance map from radiological depth:" << G4endl <<
+              "  Source position (mm): " << fSourcePos/mm << G4endl <<
+              "  Radiological depth (cm): [" << dmin << ", " << dmax << "]" << G4endl <<
+              "  Importance: [1, " << std::min(fMaxImportance, std::exp(fMu*(dmax-dmin))) << "]" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ImportanceMap::ApplyWeightWindow(const G4Step& step, G4ParticleChange& change) const
+{
+    // photons are checked once each time they cross into a new voxel
+    G4StepPoint* post = step.GetPostStepPoint();
+    if (post->GetStepStatus() != fGeomBoundary) { return; }
+
+    G4Track* track = step.GetTrack();
+    if (track->GetDefinition() != G4Gamma::Definition() || track->GetTrackStatus() != fAlive) { return; }
+
+    const G4VTouchable* touch = post->GetTouchable();
+    if (!touch || touch->GetVolume() != fVoxelVolume) { return; }
+
+    // copy numbers of X, Y and Z replicas are at depth 0, 1 and 2 respectively
+    G4long idx = fFlatIndex ? touch->GetReplicaNumber(0) :
+        touch->GetReplicaNumber(2)*fNy*fNx + touch->GetReplicaNumber(1)*fNx + touch->GetReplicaNumber(0);
+
+    G4double w      = track->GetWeight();
+    G4double wtgt   = 1./fImportance[idx];
+    G4double wlower = wtgt/std::sqrt(fWindowRatio);
+    G4double wupper = wtgt*std::sqrt(fWindowRatio);
+
+    if (w > wupper) {
+        // split: current track continues as one of the copies, the rest are secondaries of the weight window process
+        G4int ncopies = std::min(fMaxSplit, std::max(2, (G4int)std::ceil(w/wtgt)));
+        G4double wsplit = w/ncopies;
+        change.ProposeWeight(wsplit);
+        change.SetSecondaryWeightByProcess(true);
+        change.SetNumberOfSecondaries(ncopies-1);
+        for (G4int i=1; i<ncopies; ++i) {
+            G4Track* copy = new G4Track(new G4DynamicParticle(*track->GetDynamicParticle()), post->GetGlobalTime(), post->GetPosition());
+            copy->SetWeight(wsplit);
+            copy->SetTouchableHandle(post->GetTouchableHandle());
+            change.AddSecondary(copy);
+        }
+    } else if (w < wlower) {
+        // russian roulette: survivors continue at the target weight
+        if (G4UniformRand()*wtgt < w) {
+            change.ProposeWeight(wtgt);
+        } else {
+            change.ProposeTrackStatus(fStopAndKill);
+        }
+    }
+}
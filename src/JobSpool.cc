@@ -0,0 +1,225 @@
+#include "JobSpool.hh"
+#include "SpoolMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "DoseEngine.hh"
+
+#include "G4UImanager.hh"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cerrno>
+#include <climits>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+namespace {
+    G4double WallClock() {
+        return std::chrono::duration<G4double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    G4bool EndsWith(const std::string& s, const std::string& suffix) {
+        return s.size() >= suffix.size() && s.compare(s.size()-suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    G4String Resolve(const G4String& dir, const G4String& path) {
+        if (path.empty() || path[0] == '/') { return path; }
+        return dir + "/" + path;
+    }
+
+    G4bool MakeDirs(const std::string& path) {
+        for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos+1)) {
+            std::string sub = path.substr(0, pos);
+            if (mkdir(sub.c_str(), 0755) != 0 && errno != EEXIST) { return false; }
+            if (pos == std::string::npos) { break; }
+        }
+        return true;
+    }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+JobSpool* JobSpool::instance = 0;
+
+JobSpool* JobSpool::getInstance()
+{
+    if (instance == 0) instance = new JobSpool();
+    return instance;
+}
+
+JobSpool::JobSpool()
+    : fPollInterval(1.), fIdleTimeout(0), fJobs(0), fEvents(0), fWallTime(0), fInitSaved(0)
+{
+    fMessenger = new SpoolMessenger(this);
+}
+
+JobSpool::~JobSpool()
+{
+    delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void JobSpool::Watch(const G4String& spoolDir)
+{
+    // job paths are resolved against the spool, which must stay valid while jobs change the working directory
+    char buf[PATH_MAX];
+    G4String spool = realpath(spoolDir.c_str(), buf) ? G4String(buf) : spoolDir;
+    G4cout << "Watching spool directory \"" << spool << "\" for jobs" << G4endl;
+
+    fJobs = 0; fEvents = 0; fWallTime = 0; fInitSaved = 0;
+    G4String stopFile = spool + "/stop";
+    G4double idleSince = WallClock();
+    while (true) {
+        struct stat st;
+        if (stat(stopFile.c_str(), &st) == 0) {
+            std::remove(stopFile.c_str());
+            G4cout << "Spool: stop requested" << G4endl;
+            break;
+        }
+
+        std::vector<Job> jobs = ListJobs(spool);
+        if (jobs.empty()) {
+            if (fIdleTimeout > 0 && WallClock() - idleSince > fIdleTimeout) {
+                G4cout << "Spool: no jobs for " << fIdleTimeout << " s, stopping" << G4endl;
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::duration<G4double>(fPollInterval));
+            continue;
+        }
+
+        // claim the oldest job; the rename fails if another process took it first
+        Job& job = jobs.front();
+        G4String pending = spool + "/" + job.name + ".job";
+        G4String running = spool + "/" + job.name + ".running";
+        if (std::rename(pending.c_str(), running.c_str()) != 0) { continue; }
+
+        G4bool ok = ReadJob(spool, job) && RunJob(spool, job);
+        G4String finished = spool + "/" + job.name + (ok ? ".done" : ".failed");
+        std::rename(running.c_str(), finished.c_str());
+        idleSince = WallClock();
+    }
+
+    G4cout << "Spool summary: " << fJobs << " jobs, " << fEvents << " events in " << fWallTime << " s";
+    if (fWallTime > 0) { G4cout << " (" << fEvents/fWallTime << " events/s)"; }
+    G4cout << ", initialization time saved: " << fInitSaved << " s" << G4endl;
+}
+
+std::vector<JobSpool::Job> JobSpool::ListJobs(const G4String& spoolDir) const
+{
+    std::vector<Job> jobs;
+    DIR* dir = opendir(spoolDir.c_str());
+    if (!dir) {
+        G4cerr << "Spool: cannot open directory \"" << spoolDir << "\"" << G4endl;
+        return jobs;
+    }
+    while (struct dirent* entry = readdir(dir)) {
+        std::string fname = entry->d_name;
+        if (!EndsWith(fname, ".job")) { continue; }
+        struct stat st;
+        if (stat((spoolDir + "/" + fname).c_str(), &st) != 0) { continue; }
+        Job job;
+        job.name = fname.substr(0, fname.size()-4);
+        job.submitted = st.st_mtim.tv_sec + 1e-9*st.st_mtim.tv_nsec;
+        jobs.push_back(job);
+    }
+    closedir(dir);
+
+    // first in, first out; ties broken by name
+    std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) {
+        return a.submitted < b.submitted || (a.submitted == b.submitted && a.name < b.name);
+    });
+    return jobs;
+}
+
+G4bool JobSpool::ReadJob(const G4String& spoolDir, Job& job) const
+{
+    std::ifstream infile(spoolDir + "/" + job.name + ".running");
+    if (!infile.is_open()) {
+        G4cerr << "Spool: cannot read job \"" << job.name << "\"" << G4endl;
+        return false;
+    }
+    std::string line;
+    while (std::getline(infile, line)) {
+        std::stringstream ss(line);
+        std::string key, value;
+        if (!(ss >> key >> value) || key[0] == '#') { continue; }
+        if (key == "macro")         { job.macro = Resolve(spoolDir, value); }
+        else if (key == "geometry") { job.geometry = Resolve(spoolDir, value); }
+        else if (key == "output")   { job.output = Resolve(spoolDir, value); }
+        else { G4cerr << "Spool: unknown key \"" << key << "\" in job \"" << job.name << "\"" << G4endl; }
+    }
+    if (job.macro.empty()) {
+        G4cerr << "Spool: job \"" << job.name << "\" has no macro" << G4endl;
+        return false;
+    }
+    if (job.output.empty()) { job.output = spoolDir + "/" + job.name; }
+    return true;
+}
+
+G4bool JobSpool::RunJob(const G4String& spoolDir, const Job& job)
+{
+    G4double start = WallClock();
+    G4double queueWait = start - job.submitted;
+    G4cout << "Spool: starting job \"" << job.name << "\" (queued " << queueWait << " s)" << G4endl;
+
+    // output files are written to the working directory
+    char cwd[PATH_MAX];
+    if (!getcwd(cwd, sizeof(cwd)) || !MakeDirs(job.output) || chdir(job.output.c_str()) != 0) {
+        G4cerr << "Spool: cannot use output directory \"" << job.output << "\"" << G4endl;
+        return false;
+    }
+
+    const DetectorConstruction* detector = DetectorConstruction::getInstance();
+    DoseEngine* engine = DoseEngine::getInstance();
+    G4int constructCount = detector->GetConstructCount();
+    G4bool cold = (engine->GetColdInitTime() <= 0);
+    long int eventsBefore = engine->GetEventsProcessed();
+
+    G4UImanager* UI = G4UImanager::GetUIpointer();
+    G4int status = 0;
+    if (!job.geometry.empty() && job.geometry != engine->GetGeometryFile()) {
+        status = UI->ApplyCommand("/det/geo " + job.geometry);
+    }
+    if (status == 0) {
+        status = UI->ApplyCommand("/control/execute " + job.macro);
+    }
+    if (chdir(cwd) != 0) {
+        G4cerr << "Spool: cannot return to \"" << cwd << "\"" << G4endl;
+    }
+
+    // geometry reloads are timed by the engine's init timer (stopped at the first BeginOfRunAction after Construct())
+    G4double wall = WallClock() - start;
+    G4double setup = (detector->GetConstructCount() != constructCount) ? engine->GetInitTimer().GetRealElapsed() : 0.;
+    G4double saved = cold ? 0. : std::max(0., engine->GetColdInitTime() - setup);
+    long int events = engine->GetEventsProcessed() - eventsBefore;
+
+    fJobs++;
+    fEvents += events;
+    fWallTime += wall;
+    fInitSaved += saved;
+
+    G4cout << "Spool: job \"" << job.name << "\" " << (status == 0 ? "done" : "failed") << ": queue wait " << queueWait
+        << " s, setup " << setup << " s, init saved " << saved << " s, " << events << " events in " << wall << " s";
+    if (wall > 0) { G4cout << " (" << events/wall << " events/s)"; }
+    G4cout << G4endl;
+
+    G4String logName = spoolDir + "/jobs.csv";
+    struct stat st;
+    G4bool header = (stat(logName.c_str(), &st) != 0);
+    std::ofstream log(logName, std::ios::app);
+    if (header) {
+        log << "job,status,queue_wait_s,setup_s,init_saved_s,wall_s,events,events_per_s" << std::endl;
+    }
+    log << job.name << "," << (status == 0 ? "done" : "failed") << "," << queueWait << "," << setup << "," << saved << ","
+        << wall << "," << events << "," << (wall > 0 ? events/wall : 0.) << std::endl;
+
+    return status == 0;
+}
@@ -0,0 +1,67 @@
+#include "KermaTable.hh"
+
+#include "G4EmCalculator.hh"
+#include "G4Gamma.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+KermaTable::KermaTable()
+    : fEnabled(false),
+    fNbins(300), fEmin(1*keV), fEmax(100*MeV)
+{
+    fLnEmin = std::log(fEmin);
+    fInvDlnE = (fNbins-1)/(std::log(fEmax) - fLnEmin);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double KermaTable::ComptonEnergyFraction(G4double ekin)
+{
+    // mean fraction of the photon energy given to the electron, integrating the Klein-Nishina cross section over
+    //   eps = E'/E in [1/(1+2k), 1] (Simpson's rule)
+    G4double k = ekin/electron_mass_c2;
+    G4double eps0 = 1./(1. + 2.*k);
+    const G4int n = 200;
+    G4double h = (1. - eps0)/n;
+    G4double sigma = 0, sigmaTr = 0;
+    for (G4int i=0; i<=n; ++i) {
+        G4double eps = eps0 + i*h;
+        G4double cost = 1. - (1./eps - 1.)/k;
+        G4double dsig = (1./eps + eps)*(1. - eps*(1. - cost*cost)/(1. + eps*eps));
+        G4double w = (i == 0 || i == n) ? 1. : (i % 2 ? 4. : 2.);
+        sigma   += w*dsig;
+        sigmaTr += w*dsig*(1. - eps);
+    }
+    return sigma > 0 ? sigmaTr/sigma : 0.;
+}
+
+void KermaTable::Build()
+{
+    const G4MaterialTable* materials = G4Material::GetMaterialTable();
+    G4ParticleDefinition* gamma = G4Gamma::Definition();
+    G4EmCalculator calc;
+
+    fMuTr.assign(materials->size(), std::vector<G4double>(fNbins, 0));
+    for (size_t m=0; m<materials->size(); ++m) {
+        const G4Material* mat = (*materials)[m];
+        for (G4int b=0; b<fNbins; ++b) {
+            G4double ekin = std::exp(fLnEmin + b/fInvDlnE);
+            G4double mu = calc.ComputeCrossSectionPerVolume(ekin, gamma, "phot", mat);
+            mu += calc.ComputeCrossSectionPerVolume(ekin, gamma, "compt", mat)*ComptonEnergyFraction(ekin);
+            if (ekin > 2.*electron_mass_c2) {
+                mu += calc.ComputeCrossSectionPerVolume(ekin, gamma, "conv", mat)*(ekin - 2.*electron_mass_c2)/ekin;
+            }
+            fMuTr[m][b] = mu;
+        }
+    }
+
+    G4cout << "Kerma: mu_tr/rho tabulated for " << materials->size() << " materials" << G4endl;
+    for (size_t m=0; m<materials->size(); ++m) {
+        const G4Material* mat = (*materials)[m];
+        if (mat->GetName() != "G4_WATER") { continue; }
+        G4cout << "  " << mat->GetName() << " mu_tr/rho (cm2/g): " << GetMuTr(mat, 100*keV)/mat->GetDensity()/(cm2/g)
+            << " at 100 keV, " << GetMuTr(mat, 1.25*MeV)/mat->GetDensity()/(cm2/g) << " at 1.25 MeV" << G4endl;
+    }
+}
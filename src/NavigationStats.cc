@@ -0,0 +1,5 @@
+#include "NavigationStats.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreadLocal G4long NavigationStats::sComputeMaterialCalls = 0;
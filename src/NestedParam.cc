@@ -1,4 +1,5 @@
 #include "NestedParam.hh"
+#include "NavigationStats.hh"
 
 #include "G4VPhysicalVolume.hh"
 #include "G4VTouchable.hh"
@@ -32,6 +33,8 @@ void NestedParam::SetDimVoxel( G4double tempdx, G4double tempdy, G4double tempdz
 // Material assignment to geometry.
 G4Material* NestedParam::ComputeMaterial(G4VPhysicalVolume*, const G4int copyNoX, const G4VTouchable* parentTouch)
 {
+	NavigationStats::CountComputeMaterial();
+
 	// protection for initialization and vis at idle state, just spit back something
 	if(parentTouch==0) return matVec[0];
 
@@ -1,29 +1,96 @@
 #include "PhysicsList.hh"
+#include "PhysicsListMessenger.hh"
+#include "WeightWindowPhysics.hh"
 
 // include G4VPhysicsConstructor classes to be registered in G4VModularPhysicsList
 #include "G4DecayPhysics.hh"
 #include "G4RadioactiveDecayPhysics.hh"
 #include "G4EmStandardPhysics_option4.hh"
 #include "G4EmStandardPhysics_option3.hh"
+#include "G4EmStandardPhysics.hh"
+#include "G4EmLivermorePhysics.hh"
+#include "G4StepLimiterPhysics.hh"
+#include "G4FastSimulationPhysics.hh"
+#include "G4ParallelWorldPhysics.hh"
+
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4ProductionCuts.hh"
+#include "G4UserLimits.hh"
+#include "G4Threading.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4Version.hh"
+
+#include <sstream>
+#include <iomanip>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 64-bit FNV-1a hash
+static uint64_t fnv1a(const std::string& str) {
+  uint64_t hash = 14695981039346656037ULL;
+  for (unsigned char c : str) {
+    hash ^= c;
+    hash *= 1099511628211ULL;
+  }
+  return hash;
+}
+
+static bool dir_exists(const std::string& path) {
+  struct stat buf;
+  return stat(path.c_str(), &buf) == 0 && S_ISDIR(buf.st_mode);
+}
+
+// tables are stored flat in one directory, so removing the files and the directory is sufficient
+static void remove_dir(const std::string& path) {
+  DIR* dir = opendir(path.c_str());
+  if (!dir) { return; }
+  while (struct dirent* entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name != "." && name != "..") { unlink((path + "/" + name).c_str()); }
+  }
+  closedir(dir);
+  rmdir(path.c_str());
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-PhysicsList::PhysicsList() : G4VModularPhysicsList() {
+PhysicsList::PhysicsList() : G4VModularPhysicsList(),
+  fProfile("reference"), fEmName("opt3"), fWoodcock(false), fCacheState("off")
+{
+
+  fMessenger = new PhysicsListMessenger(this);
 
   // Physics of unstable particles
-  RegisterPhysics(new G4DecayPhysics());
+  fDecayPhysics = new G4DecayPhysics();
+  RegisterPhysics(fDecayPhysics);
 
   // Radioactive decay
-  RegisterPhysics(new G4RadioactiveDecayPhysics());
+  fRadDecayPhysics = new G4RadioactiveDecayPhysics();
+  RegisterPhysics(fRadDecayPhysics);
 
   // EM physics
   RegisterPhysics(new G4EmStandardPhysics_option3());
+
+  // per-region max step and tracking cuts (G4UserLimits attached to regions)
+  RegisterPhysics(new G4StepLimiterPhysics());
+
+  // photon weight windows of the importance map (/det/vr/weightWindow), activated per run
+  RegisterPhysics(new WeightWindowPhysics());
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 PhysicsList::~PhysicsList()
 {
+  delete fMessenger;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -31,4 +98,214 @@ PhysicsList::~PhysicsList()
 void PhysicsList::SetCuts()
 {
   G4VUserPhysicsList::SetCuts();
+
+  if (G4Threading::IsMasterThread()) {
+    G4cout << "Physics profile: " << fProfile << " (EM: " << fEmName << ")" << (fWoodcock ? ", Woodcock photon tracking in phantom" : "") << G4endl;
+  }
+
+  // region cuts must be applied after the defaults, which would otherwise overwrite the world region cuts
+  if (G4Threading::IsMasterThread()) {
+    ApplyRegionSettings();
+    PrepareTableCache();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsList::PrepareTableCache()
+{
+  if (fCacheDir.empty()) { return; }
+
+  // everything the tables depend on. Phantom materials are named mat<ID>_<den> and shared per (material ID, density),
+  //   but the tables follow the order of the material table, which depends on the order the phantom first uses them;
+  //   so each material is keyed by its name, density and element Z and mass fractions, in table order
+  std::ostringstream key;
+  key << std::setprecision(10);
+  key << "geant4 " << G4Version << "\n";
+  // data sets are found through these variables, and their directory names carry the data set versions
+  for (const char* var : {"G4LEDATA", "G4LEVELGAMMADATA", "G4RADIOACTIVEDATA", "G4ENSDFSTATEDATA", "G4PARTICLEXSDATA",
+        "G4NEUTRONHPDATA", "G4SAIDXSDATA", "G4PIIDATA", "G4REALSURFACEDATA", "G4INCLDATA", "G4ABLADATA"}) {
+    const char* value = std::getenv(var);
+    key << "data " << var << " " << (value ? value : "") << "\n";
+  }
+  key << "profile " << fProfile << " em " << fEmName << " woodcock " << fWoodcock << "\n";
+  for (const G4Material* mat : *G4Material::GetMaterialTable()) {
+    key << "material " << mat->GetName() << " " << mat->GetDensity()/(g/cm3);
+    const G4ElementVector* elements = mat->GetElementVector();
+    const G4double* fractions = mat->GetFractionVector();
+    for (size_t i=0; i<mat->GetNumberOfElements(); ++i) {
+      key << " " << (*elements)[i]->GetZ() << ":" << fractions[i];
+    }
+    key << "\n";
+  }
+  for (const G4Region* region : *G4RegionStore::GetInstance()) {
+    const G4ProductionCuts* cuts = region->GetProductionCuts();
+    if (!cuts) { continue; }
+    key << "region " << region->GetName();
+    for (const char* particle : {"gamma", "e-", "e+", "proton"}) {
+      key << " " << cuts->GetProductionCut(particle)/mm;
+    }
+    key << "\n";
+  }
+
+  std::ostringstream hex;
+  hex << std::hex << std::setw(16) << std::setfill('0') << fnv1a(key.str());
+  fCacheKey = hex.str();
+
+  G4String path = fCacheDir + "/" + fCacheKey;
+  if (dir_exists(path)) {
+    // Geant4 falls back to building any table that fails to retrieve
+    SetPhysicsTableRetrieved(path);
+    fCacheState = "warm";
+  } else {
+    fCacheState = "cold";
+  }
+  G4cout << "Physics table cache (" << fCacheState << "): " << path << G4endl;
+}
+
+void PhysicsList::StoreTableCache()
+{
+  if (fCacheState != "cold") { return; }
+
+  // write into a private directory first so that concurrent batch processes never read a partial cache entry
+  mkdir(fCacheDir.c_str(), 0755);
+  G4String path = fCacheDir + "/" + fCacheKey;
+  G4String tmp = path + ".tmp" + std::to_string(getpid());
+  mkdir(tmp.c_str(), 0755);
+  if (!StorePhysicsTable(tmp)) {
+    G4cerr << "Failed storing physics tables to \"" << tmp << "\"" << G4endl;
+    remove_dir(tmp);
+    return;
+  }
+  if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+    // another process stored the same key first
+    remove_dir(tmp);
+  }
+  G4cout << "Stored physics tables to cache: " << path << G4endl;
+  fCacheState = "stored";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsList::SetProfile(const G4String& profile)
+{
+  // particles of all constructors were already created in ConstructParticle(); only processes are affected here
+  G4bool withDecay = (profile == "reference");
+  if (!withDecay && fDecayPhysics) {
+    RemovePhysics(fDecayPhysics);
+    RemovePhysics(fRadDecayPhysics);
+    delete fDecayPhysics;
+    delete fRadDecayPhysics;
+    fDecayPhysics = fRadDecayPhysics = nullptr;
+  } else if (withDecay && !fDecayPhysics) {
+    fDecayPhysics = new G4DecayPhysics();
+    RegisterPhysics(fDecayPhysics);
+    fRadDecayPhysics = new G4RadioactiveDecayPhysics();
+    RegisterPhysics(fRadDecayPhysics);
+  }
+  fProfile = profile;
+}
+
+void PhysicsList::SetEmPhysics(const G4String& name)
+{
+  if (name == fEmName) { return; }
+
+  // all EM constructors are of type bElectromagnetic, so they replace each other
+  if (name == "opt0") {
+    ReplacePhysics(new G4EmStandardPhysics());
+  } else if (name == "opt3") {
+    ReplacePhysics(new G4EmStandardPhysics_option3());
+  } else if (name == "opt4") {
+    ReplacePhysics(new G4EmStandardPhysics_option4());
+  } else if (name == "livermore") {
+    ReplacePhysics(new G4EmLivermorePhysics());
+  } else {
+    G4cerr << "Unknown EM physics \"" << name << "\"; keeping \"" << fEmName << "\"" << G4endl;
+    return;
+  }
+  fEmName = name;
+}
+
+void PhysicsList::SetWoodcock(G4bool enable)
+{
+  if (enable == fWoodcock) { return; }
+  if (!enable) {
+    // the fast simulation process only acts where a model is attached; without it nothing is attached
+    fWoodcock = false;
+    return;
+  }
+  G4FastSimulationPhysics* fastSim = new G4FastSimulationPhysics();
+  fastSim->ActivateFastSimulation("gamma");
+  RegisterPhysics(fastSim);
+  fWoodcock = true;
+}
+
+void PhysicsList::AddParallelWorld(const G4String& worldName)
+{
+  RegisterPhysics(new G4ParallelWorldPhysics(worldName));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsList::SetRegionCut(const G4String& region, G4double cut)
+{
+  fRegionSettings[region].cut = cut;
+}
+
+void PhysicsList::SetRegionMaxStep(const G4String& region, G4double step)
+{
+  fRegionSettings[region].maxStep = step;
+}
+
+void PhysicsList::SetRegionMinEkine(const G4String& region, G4double ekin)
+{
+  fRegionSettings[region].minEkine = ekin;
+}
+
+void PhysicsList::ApplyRegionSettings()
+{
+  G4RegionStore* store = G4RegionStore::GetInstance();
+  G4Region* worldRegion = store->GetRegion("DefaultRegionForTheWorld", false);
+  for (const auto& it : fRegionSettings) {
+    G4Region* region = (it.first == "world") ? worldRegion : store->GetRegion(it.first, false);
+    if (!region) {
+      // regions are created in DetectorConstruction::Construct(); settings are re-applied from SetCuts()
+      continue;
+    }
+    const RegionSettings& settings = it.second;
+
+    if (settings.cut >= 0) {
+      // regions without specific cuts share the world cuts object; give them their own (the phantom always has one)
+      G4ProductionCuts* cuts = region->GetProductionCuts();
+      if (!cuts || (region != worldRegion && cuts == worldRegion->GetProductionCuts())) {
+        cuts = new G4ProductionCuts();
+        region->SetProductionCuts(cuts);
+      }
+      cuts->SetProductionCut(settings.cut);
+    }
+
+    if (settings.maxStep >= 0 || settings.minEkine >= 0) {
+      G4UserLimits* limits = region->GetUserLimits();
+      if (!limits) {
+        limits = new G4UserLimits();
+        region->SetUserLimits(limits);
+      }
+      if (settings.maxStep >= 0)  { limits->SetMaxAllowedStep(settings.maxStep); }
+      if (settings.minEkine >= 0) { limits->SetUserMinEkine(settings.minEkine); }
+    }
+  }
+}
+
+void PhysicsList::ListRegions() const
+{
+  G4RegionStore* store = G4RegionStore::GetInstance();
+  G4cout << "Regions (\"world\" is an alias for DefaultRegionForTheWorld):" << G4endl;
+  for (const auto* region : *store) {
+    G4cout << "  " << region->GetName();
+    const G4ProductionCuts* cuts = region->GetProductionCuts();
+    if (cuts) {
+      G4cout << "  cut(e-): " << G4BestUnit(cuts->GetProductionCut("e-"), "Length");
+    }
+    G4cout << G4endl;
+  }
 }
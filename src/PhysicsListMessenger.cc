@@ -0,0 +1,142 @@
+#include "PhysicsListMessenger.hh"
+#include "PhysicsList.hh"
+
+#include <sstream>
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4StateManager.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsListMessenger::PhysicsListMessenger(PhysicsList * phys)
+:fPhysicsList(phys)
+{
+  Dir = new G4UIdirectory("/phys/");
+  Dir->SetGuidance(" Physics list control.");
+
+  profileCmd = new G4UIcmdWithAString("/phys/profile", this);
+  profileCmd->SetGuidance("Select the physics profile.");
+  profileCmd->SetGuidance("  reference:   decay, radioactive decay and EM physics");
+  profileCmd->SetGuidance("  lean-photon: EM physics only (MV photon beams)");
+  profileCmd->SetParameterName("profile", false);
+  profileCmd->SetCandidates("reference lean-photon");
+  profileCmd->AvailableForStates(G4State_PreInit);
+  profileCmd->SetToBeBroadcasted(false);
+
+  emCmd = new G4UIcmdWithAString("/phys/em", this);
+  emCmd->SetGuidance("Select the EM physics constructor (default: opt3).");
+  emCmd->SetParameterName("em", false);
+  emCmd->SetCandidates("opt0 opt3 opt4 livermore");
+  emCmd->AvailableForStates(G4State_PreInit);
+  emCmd->SetToBeBroadcasted(false);
+
+  tableCacheCmd = new G4UIcmdWithAString("/phys/tableCache", this);
+  tableCacheCmd->SetGuidance("Store built physics tables in this directory and retrieve them in later processes.");
+  tableCacheCmd->SetGuidance("Entries are keyed by Geant4 and data set versions, material composition and density,");
+  tableCacheCmd->SetGuidance("  production cuts and physics profile.");
+  tableCacheCmd->SetParameterName("dir", false);
+  tableCacheCmd->AvailableForStates(G4State_PreInit);
+  tableCacheCmd->SetToBeBroadcasted(false);
+
+  woodcockCmd = new G4UIcmdWithABool("/phys/woodcock", this);
+  woodcockCmd->SetGuidance("Track photons in the phantom with Woodcock (delta) tracking instead of voxel-by-voxel stepping.");
+  woodcockCmd->SetGuidance("Photons no longer stop at voxel boundaries, so the photonFluence output is not meaningful");
+  woodcockCmd->SetGuidance("  and /det/vr/weightWindow has no effect inside the phantom.");
+  woodcockCmd->SetParameterName("enable", true);
+  woodcockCmd->SetDefaultValue(true);
+  woodcockCmd->AvailableForStates(G4State_PreInit);
+  woodcockCmd->SetToBeBroadcasted(false);
+
+  regionDir = new G4UIdirectory("/phys/region/");
+  regionDir->SetGuidance(" Per-region production cuts and step limits (regions: world, phantom).");
+
+  regionCutCmd = NewRegionCommand("/phys/region/setCut",
+      "Set the production cut (all particles) of a region.", "mm");
+  regionStepCmd = NewRegionCommand("/phys/region/maxStep",
+      "Limit the step length of charged particles in a region.", "mm");
+  regionEkinCmd = NewRegionCommand("/phys/region/minEkine",
+      "Kill tracks below this kinetic energy in a region (energy is not deposited).", "keV");
+
+  regionListCmd = new G4UIcmdWithoutParameter("/phys/region/list", this);
+  regionListCmd->SetGuidance("List regions and their production cuts.");
+  regionListCmd->AvailableForStates(G4State_Idle);
+  regionListCmd->SetToBeBroadcasted(false);
+}
+
+G4UIcommand* PhysicsListMessenger::NewRegionCommand(const char* path, const char* guidance, const char* defaultUnit)
+{
+  G4UIcommand* cmd = new G4UIcommand(path, this);
+  cmd->SetGuidance(guidance);
+
+  G4UIparameter* regionPrm = new G4UIparameter("region", 's', false);
+  regionPrm->SetGuidance("region name (\"world\" for the default world region)");
+  cmd->SetParameter(regionPrm);
+
+  G4UIparameter* valuePrm = new G4UIparameter("value", 'd', false);
+  valuePrm->SetParameterRange("value>=0.");
+  cmd->SetParameter(valuePrm);
+
+  G4UIparameter* unitPrm = new G4UIparameter("unit", 's', true);
+  unitPrm->SetDefaultUnit(defaultUnit);
+  cmd->SetParameter(unitPrm);
+
+  cmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  cmd->SetToBeBroadcasted(false);
+  return cmd;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PhysicsListMessenger::~PhysicsListMessenger()
+{
+    delete   profileCmd;
+    delete   emCmd;
+    delete   tableCacheCmd;
+    delete   woodcockCmd;
+    delete   regionCutCmd;
+    delete   regionStepCmd;
+    delete   regionEkinCmd;
+    delete   regionListCmd;
+    delete   regionDir;
+	delete   Dir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PhysicsListMessenger::SetNewValue(G4UIcommand* command,G4String newValue) {
+    if (command == profileCmd) {
+        fPhysicsList->SetProfile(newValue);
+    } else if (command == emCmd) {
+        fPhysicsList->SetEmPhysics(newValue);
+    } else if (command == woodcockCmd) {
+        fPhysicsList->SetWoodcock(woodcockCmd->GetNewBoolValue(newValue));
+    } else if (command == tableCacheCmd) {
+        fPhysicsList->SetTableCache(newValue);
+    } else if (command == regionCutCmd || command == regionStepCmd || command == regionEkinCmd) {
+        G4String region, unit;
+        G4double value;
+        std::istringstream is(newValue);
+        is >> region >> value >> unit;
+        value *= G4UIcommand::ValueOf(unit);
+
+        if (command == regionCutCmd) {
+            fPhysicsList->SetRegionCut(region, value);
+        } else if (command == regionStepCmd) {
+            fPhysicsList->SetRegionMaxStep(region, value);
+        } else {
+            fPhysicsList->SetRegionMinEkine(region, value);
+        }
+
+        // after initialization regions already exist; changed cuts trigger a table rebuild at the next beamOn
+        if (G4StateManager::GetStateManager()->GetCurrentState() == G4State_Idle) {
+            fPhysicsList->ApplyRegionSettings();
+        }
+    } else if (command == regionListCmd) {
+        fPhysicsList->ListRegions();
+    }
+}
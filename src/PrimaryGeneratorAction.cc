@@ -17,15 +17,25 @@
 #include "globals.hh"
 #include "G4PrimaryParticle.hh"
 #include "G4Threading.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4Gamma.hh"
+#include "G4EmCalculator.hh"
+#include "G4PhysicalConstants.hh"
 
-// from ../main.cc
-extern long int g_eventsProcessed;
+#include "DetectorConstruction.hh"
+#include "FocusedRectangleSource.hh"
+#include "SourceVertexInfo.hh"
+
+#include <cfloat>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 
 PrimaryGeneratorAction::PrimaryGeneratorAction()
     : G4VUserPrimaryGeneratorAction(),
+    fDetector(DetectorConstruction::getInstance()),
+    fEmCalculator(new G4EmCalculator()),
+    fAirMuRun(-1),
     fParticleGun(0)
 {
     init();
@@ -36,6 +46,7 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
     delete fParticleGun;
+    delete fEmCalculator;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -48,10 +59,83 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
     // WARNING: EventID resets to 0 for every run; to handle this, we calculate continuous EventID assuming all runs have same number of events.
     //   If this assumption is broken, need to switch to a global counter that is updated by master thread after each run instead
     // auto* run = G4RunManager::GetRunManager()->GetCurrentRun();
-    // long int globalEventID = g_eventsProcessed + anEvent->GetEventID()+1;
+    // long int globalEventID = DoseEngine::getInstance()->GetEventsProcessed() + anEvent->GetEventID()+1;
     // G4Random::setTheSeed(globalEventID);
     // G4cout << "Run #" << run->GetRunID() << ", EventID: " << anEvent->GetEventID() << " (global EventID: "<<globalEventID<<"), seed: " << G4Random::getTheSeed() << " (RNG ptr: "<<(void*)G4Random::getTheEngine()<<")" << G4endl;
-    generate(anEvent);
+    // every primary is an independent history (/det/scorer/historiesPerEvent)
+    for (G4int i=0; i<fDetector->GetHistoriesPerEvent(); ++i) {
+        generate(anEvent);
+    }
+    if (fDetector->IsFastForward()) {
+        FastForward(anEvent);
+    }
+}
+
+void PrimaryGeneratorAction::FastForward(G4Event* anEvent)
+{
+    // charged primaries lose energy and scatter in air, so only photons are moved
+    G4ThreeVector lo, hi;
+    fDetector->GetPhantomBounds(lo, hi);
+    for (G4int v=0; v<anEvent->GetNumberOfPrimaryVertex(); ++v) {
+        G4PrimaryVertex* vertex = anEvent->GetPrimaryVertex(v);
+        G4PrimaryParticle* particle = vertex->GetPrimary();
+        if (!particle || particle->GetParticleDefinition() != G4Gamma::Definition()) { continue; }
+
+        // entry distance along the ray into the phantom box (slab method)
+        G4ThreeVector pos = vertex->GetPosition();
+        G4ThreeVector dir = particle->GetMomentumDirection();
+        G4double tin = 0, tout = DBL_MAX;
+        for (G4int ax=0; ax<3 && tin<=tout; ++ax) {
+            if (std::fabs(dir[ax]) < 1e-12) {
+                if (pos[ax] < lo[ax] || pos[ax] > hi[ax]) { tout = -1; }
+                continue;
+            }
+            G4double t1 = (lo[ax] - pos[ax])/dir[ax];
+            G4double t2 = (hi[ax] - pos[ax])/dir[ax];
+            tin = std::max(tin, std::min(t1, t2));
+            tout = std::min(tout, std::max(t1, t2));
+        }
+        // misses the phantom, or already inside
+        if (tin > tout || tin <= 0) { continue; }
+
+        // stop just short of the surface so that the photon still enters the phantom through its boundary
+        G4double skip = std::max(0., tin - 1*um);
+        G4ThreeVector newPos = pos + skip*dir;
+        if (!vertex->GetUserInformation()) { vertex->SetUserInformation(new SourceVertexInfo(pos)); }
+        vertex->SetPosition(newPos.x(), newPos.y(), newPos.z());
+        vertex->SetT0(vertex->GetT0() + skip/c_light);
+
+        if (fDetector->IsAirAttenuation()) {
+            particle->SetWeight(particle->GetWeight()*std::exp(-skip*GetAirMu(particle->GetKineticEnergy())));
+        }
+    }
+}
+
+static const G4int    kAirMuBins = 300;
+static const G4double kAirMuEmin = 1*keV;
+static const G4double kAirMuEmax = 100*MeV;
+
+G4double PrimaryGeneratorAction::GetAirMu(G4double ekin)
+{
+    // the world material and the physics tables may change between runs, so the table is built once per run
+    const G4Run* run = G4RunManager::GetRunManager()->GetCurrentRun();
+    G4int runID = run ? run->GetRunID() : -1;
+    G4double lnEmin = std::log(kAirMuEmin);
+    G4double dlnE = (std::log(kAirMuEmax) - lnEmin)/(kAirMuBins - 1);
+    if (fAirMu.empty() || runID != fAirMuRun) {
+        fAirMu.resize(kAirMuBins);
+        for (G4int i=0; i<kAirMuBins; ++i) {
+            G4double lambda = fEmCalculator->ComputeGammaAttenuationLength(std::exp(lnEmin + i*dlnE), fDetector->GetWorldMaterial());
+            fAirMu[i] = (lambda > 0 && lambda < DBL_MAX) ? 1./lambda : 0.;
+        }
+        fAirMuRun = runID;
+    }
+
+    // linear interpolation in log(E)
+    G4double x = (std::log(ekin) - lnEmin)/dlnE;
+    G4int b = std::min(kAirMuBins-2, std::max(0, (G4int)x));
+    G4double f = std::min(1., std::max(0., x - b));
+    return fAirMu[b] + f*(fAirMu[b+1] - fAirMu[b]);
 }
 
 
@@ -60,14 +144,24 @@ void PrimaryGeneratorAction::init() {
     fParticleGun = new G4GeneralParticleSource();
 }
 void PrimaryGeneratorAction::generate(G4Event* anEvent) {
-    fParticleGun->GeneratePrimaryVertex(anEvent);
+    // the rectangle source is shared and read-only during runs (/rect/enable)
+    FocusedRectangleSource* rect = FocusedRectangleSource::getInstance();
+    if (rect->IsEnabled()) {
+        rect->GeneratePrimaryVertex(anEvent);
+    } else {
+        fParticleGun->GeneratePrimaryVertex(anEvent);
+    }
 }
+// GPS and rectangle source sampling only depend on the RNG state
+G4String PrimaryGeneratorAction::GetSourceState() { return ""; }
+void PrimaryGeneratorAction::SetSourceState(const G4String&) {}
 /* ############################################################################# */
 #else
 
 void PrimaryGeneratorAction::init() {
     fParticleGun = new G4ParticleGun();
     fPlaceholder = 0; //placeholder for where we are in the file
+    fBatchStart = fBatchSize = 0;
     fPT = G4ParticleTable::GetParticleTable();
 
 #ifdef G4MULTITHREADED
@@ -123,7 +217,7 @@ void PrimaryGeneratorAction::BatchHistories()
 {
     int threadid = G4Threading::G4GetThreadId();
     int batchSize = default_batchSize;
-    int lineSize = 21; // must match sum of included data length [bytes]
+    int lineSize = psf_lineSize;
 
     char pType;				//1 byte particle type
     G4float E, X, Y, U, V;  //4 byte floating points
@@ -197,6 +291,9 @@ void PrimaryGeneratorAction::BatchHistories()
 
         // G4cout << "(t, E, X, Y, Z, U, V, W) = (" << G4int(pType) << ", " << temp.E << ", " << temp.X << ", " << temp.Y << ", " << temp.Z << ", " << temp.U << ", " << temp.V << ", " << temp.W << ")" << G4endl;
     }
+    fBatchFile = psfile;
+    fBatchStart = fPlaceholder;
+    fBatchSize = batchSize;
     fPlaceholder += lineSize*batchSize;
     infile.close();
 
@@ -209,6 +306,45 @@ void PrimaryGeneratorAction::BatchHistories()
         fPlaceholder = 0;
     }
 }
+
+G4String PrimaryGeneratorAction::GetSourceState()
+{
+    // "<offset> <file> [<file> ...]": offset (bytes) of the next unused particle in the first file, followed by the
+    // files still to be read; particles already loaded into pList but not yet used are not skipped on restart
+    int threadid = G4Threading::G4GetThreadId();
+#ifndef G4MULTITHREADED
+    threadid = -2;
+#endif
+    std::vector<std::string> files = psfvects.psFiles(threadid);
+    G4long offset = fPlaceholder;
+    if (!pList.empty()) {
+        if (files.empty() || files.back() != fBatchFile) { files.push_back(fBatchFile); } // batch ended its file
+        offset = fBatchStart + (G4long)(fBatchSize - pList.size())*psf_lineSize;
+    }
+    std::ostringstream os;
+    os << offset;
+    for (auto it = files.rbegin(); it != files.rend(); ++it) { os << " " << *it; }
+    return os.str();
+}
+
+void PrimaryGeneratorAction::SetSourceState(const G4String& state)
+{
+    int threadid = G4Threading::G4GetThreadId();
+#ifndef G4MULTITHREADED
+    threadid = -2;
+#endif
+    std::istringstream is(state);
+    G4long offset;
+    if (!(is >> offset)) { return; }
+    std::vector<std::string> files;
+    std::string fname;
+    while (is >> fname) { files.insert(files.begin(), fname); }
+
+    psfvects.psFiles(threadid) = files;
+    fPlaceholder = offset;
+    pList.clear();
+    G4cout << "PSF: resuming at particle " << offset/psf_lineSize << " of \"" << (files.empty() ? "" : files.back()) << "\"" << G4endl;
+}
 #endif
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
@@ -0,0 +1,47 @@
+#include "ProgressMessenger.hh"
+#include "ProgressReporter.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProgressMessenger::ProgressMessenger(ProgressReporter * reporter)
+:fReporter(reporter)
+{
+  Dir = new G4UIdirectory("/progress/");
+  Dir->SetGuidance(" Progress reporting during runs.");
+
+  intervalCmd = new G4UIcmdWithADoubleAndUnit("/progress/interval", this);
+  intervalCmd->SetGuidance("Print events/sec, thread balance and ETA at this interval during each run (0 disables).");
+  intervalCmd->SetParameterName("interval", false);
+  intervalCmd->SetRange("interval>=0");
+  intervalCmd->SetDefaultUnit("s");
+  intervalCmd->SetToBeBroadcasted(false);
+
+  statusFileCmd = new G4UIcmdWithAString("/progress/statusFile", this);
+  statusFileCmd->SetGuidance("Also write the progress to this file (replaced atomically at each report).");
+  statusFileCmd->SetParameterName("fname", false);
+  statusFileCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProgressMessenger::~ProgressMessenger()
+{
+    delete   intervalCmd;
+    delete   statusFileCmd;
+	delete   Dir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressMessenger::SetNewValue(G4UIcommand* command,G4String newValue) {
+    if (command == intervalCmd) {
+        fReporter->SetInterval(intervalCmd->GetNewDoubleValue(newValue)/s);
+    } else if (command == statusFileCmd) {
+        fReporter->SetStatusFile(newValue);
+    }
+}
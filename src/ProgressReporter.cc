@@ -0,0 +1,167 @@
+#include "ProgressReporter.hh"
+#include "ProgressMessenger.hh"
+
+#include "G4ios.hh"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ProgressReporter* ProgressReporter::instance = 0;
+ProgressReporter::Slot ProgressReporter::fSlots[ProgressReporter::kMaxSlots];
+
+ProgressReporter* ProgressReporter::getInstance()
+{
+    if (instance == 0) instance = new ProgressReporter();
+    return instance;
+}
+
+ProgressReporter::ProgressReporter()
+    : fInterval(0), fRunID(0), fEventsToProcess(0), fNThreads(1), fLastEvents(0), fTailIdle(0), fStopping(true)
+{
+    fMessenger = new ProgressMessenger(this);
+}
+
+ProgressReporter::~ProgressReporter()
+{
+    Stop();
+    delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressReporter::Start(G4int runID, G4long eventsToProcess, G4int nThreads)
+{
+    Stop();
+    fStartTime = fLastTime = std::chrono::steady_clock::now();
+    for (auto& slot : fSlots) {
+        slot.events.store(0, std::memory_order_relaxed);
+        slot.lastEvent.store(fStartTime.time_since_epoch().count(), std::memory_order_relaxed);
+    }
+    fRunID = runID;
+    fEventsToProcess = eventsToProcess;
+    fNThreads = std::max(1, std::min(nThreads, kMaxSlots));
+    fLastEvents = 0;
+    fStopping = false;
+
+    if (fInterval <= 0) { return; }
+    fThread = std::thread(&ProgressReporter::Loop, this);
+}
+
+void ProgressReporter::Stop()
+{
+    if (fStopping) { return; }
+    ReportTailIdle();
+    if (!fThread.joinable()) {
+        fStopping = true;
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(fMutex);
+        fStopping = true;
+    }
+    fWakeup.notify_all();
+    fThread.join();
+    Report(true);
+}
+
+void ProgressReporter::ReportTailIdle()
+{
+    // called at the end of the run, when every worker has finished its last event. The event loop ends with the last
+    // event of any worker; the merge of the worker runs after that is not idle time
+    std::vector<std::chrono::steady_clock::time_point> last(fNThreads);
+    std::chrono::steady_clock::time_point end = fStartTime;
+    for (G4int i=0; i<fNThreads; ++i) {
+        last[i] = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(fSlots[i].lastEvent.load(std::memory_order_relaxed)));
+        end = std::max(end, last[i]);
+    }
+    G4double elapsed = std::chrono::duration<G4double>(end - fStartTime).count();
+    if (elapsed <= 0) { return; }
+
+    G4double sum = 0, max = 0;
+    for (G4int i=0; i<fNThreads; ++i) {
+        // slots start at the start of the run, so workers without any event were idle for the whole event loop
+        G4double idle = std::chrono::duration<G4double>(end - last[i]).count();
+        sum += idle;
+        max = std::max(max, idle);
+    }
+    fTailIdle = sum/(fNThreads*elapsed);
+    G4cout << "Tail idle (run " << fRunID << "): mean " << sum/fNThreads << " s, max " << max << " s ("
+        << 100.*fTailIdle << "% of worker time)" << G4endl;
+}
+
+void ProgressReporter::Loop()
+{
+    // G4cout is thread-local in multithreaded builds and only set up on the threads Geant4 starts itself
+    G4iosInitialization();
+    {
+        std::unique_lock<std::mutex> lock(fMutex);
+        auto interval = std::chrono::duration<G4double>(fInterval);
+        while (!fWakeup.wait_for(lock, interval, [this]{ return fStopping; })) {
+            Report(false);
+        }
+    }
+    G4iosFinalization();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ProgressReporter::Report(G4bool final)
+{
+    auto now = std::chrono::steady_clock::now();
+    G4double elapsed = std::chrono::duration<G4double>(now - fStartTime).count();
+    G4double sinceLast = std::chrono::duration<G4double>(now - fLastTime).count();
+
+    G4long done = 0;
+    G4long minEvents = -1, maxEvents = 0;
+    for (G4int i=0; i<fNThreads; ++i) {
+        G4long n = fSlots[i].events.load(std::memory_order_relaxed);
+        done += n;
+        minEvents = (minEvents < 0) ? n : std::min(minEvents, n);
+        maxEvents = std::max(maxEvents, n);
+    }
+    G4double rate = (sinceLast > 0) ? (done - fLastEvents)/sinceLast : 0;
+    G4double avgRate = (elapsed > 0) ? done/elapsed : 0;
+    G4double eta = (avgRate > 0) ? (fEventsToProcess - done)/avgRate : -1;
+    // slowest thread relative to the mean; 1 is perfectly balanced
+    G4double balance = (done > 0) ? minEvents*fNThreads/(G4double)done : 1;
+    fLastTime = now;
+    fLastEvents = done;
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(1);
+    ss << "Progress (run " << fRunID << "): " << done << "/" << fEventsToProcess << " events ("
+        << (fEventsToProcess > 0 ? 100.*done/fEventsToProcess : 0.) << "%), "
+        << rate << " events/s (avg " << avgRate << "), thread balance " << std::setprecision(2) << balance
+        << " [" << minEvents << ".." << maxEvents << "], ";
+    if (final)         { ss << "done in " << std::setprecision(1) << elapsed << " s"; }
+    else if (eta >= 0) { ss << "ETA " << std::setprecision(0) << eta << " s"; }
+    else               { ss << "ETA unknown"; }
+    G4cout << ss.str() << G4endl;
+
+    if (fStatusFile.empty()) { return; }
+    G4String tmp = fStatusFile + ".tmp";
+    {
+        std::ofstream outfile(tmp);
+        if (!outfile.is_open()) { return; }
+        outfile << std::fixed << std::setprecision(3);
+        outfile << "state " << (final ? "finished" : "running") << "\n"
+            << "run " << fRunID << "\n"
+            << "events_done " << done << "\n"
+            << "events_total " << fEventsToProcess << "\n"
+            << "elapsed_s " << elapsed << "\n"
+            << "events_per_s " << rate << "\n"
+            << "avg_events_per_s " << avgRate << "\n"
+            << "eta_s " << (final ? 0. : eta) << "\n"
+            << "thread_balance " << balance << "\n"
+            << "thread_events";
+        for (G4int i=0; i<fNThreads; ++i) { outfile << " " << fSlots[i].events.load(std::memory_order_relaxed); }
+        outfile << "\n";
+    }
+    std::rename(tmp.c_str(), fStatusFile.c_str());
+}
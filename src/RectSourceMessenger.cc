@@ -0,0 +1,162 @@
+#include "RectSourceMessenger.hh"
+#include "FocusedRectangleSource.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWith3Vector.hh"
+#include "G4UIcmdWith3VectorAndUnit.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4ParticleTable.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RectSourceMessenger::RectSourceMessenger(FocusedRectangleSource * source)
+:fSource(source)
+{
+  Dir = new G4UIdirectory("/rect/");
+  Dir->SetGuidance(" Focused rectangle source: replaces GPS for divergent rectangular fields and beamlets.");
+  Dir->SetGuidance(" Commands mirror the /gps/ commands of square_field_gps.mac (plane rectangle, focused, Arb Lin).");
+
+  enableCmd = new G4UIcmdWithABool("/rect/enable", this);
+  enableCmd->SetGuidance("Generate primaries from the rectangle source instead of GPS.");
+  enableCmd->SetParameterName("enable", true);
+  enableCmd->SetDefaultValue(true);
+  enableCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  enableCmd->SetToBeBroadcasted(false);
+
+  particleCmd = new G4UIcmdWithAString("/rect/particle", this);
+  particleCmd->SetGuidance("Set the particle type (default: gamma).");
+  particleCmd->SetParameterName("particle", false);
+  particleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  particleCmd->SetToBeBroadcasted(false);
+
+  listCmd = new G4UIcmdWithoutParameter("/rect/list", this);
+  listCmd->SetGuidance("Print the source settings.");
+  listCmd->SetToBeBroadcasted(false);
+
+  posDir = new G4UIdirectory("/rect/pos/");
+  posDir->SetGuidance(" Source plane.");
+
+  centreCmd = new G4UIcmdWith3VectorAndUnit("/rect/pos/centre", this);
+  centreCmd->SetGuidance("Set the centre of the source rectangle.");
+  centreCmd->SetParameterName("x", "y", "z", false);
+  centreCmd->SetDefaultUnit("cm");
+  centreCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  centreCmd->SetToBeBroadcasted(false);
+
+  halfxCmd = new G4UIcmdWithADoubleAndUnit("/rect/pos/halfx", this);
+  halfxCmd->SetGuidance("Set the half size of the rectangle along rot1.");
+  halfxCmd->SetParameterName("halfx", false);
+  halfxCmd->SetRange("halfx>=0.");
+  halfxCmd->SetDefaultUnit("cm");
+  halfxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  halfxCmd->SetToBeBroadcasted(false);
+
+  halfyCmd = new G4UIcmdWithADoubleAndUnit("/rect/pos/halfy", this);
+  halfyCmd->SetGuidance("Set the half size of the rectangle along rot2.");
+  halfyCmd->SetParameterName("halfy", false);
+  halfyCmd->SetRange("halfy>=0.");
+  halfyCmd->SetDefaultUnit("cm");
+  halfyCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  halfyCmd->SetToBeBroadcasted(false);
+
+  rot1Cmd = new G4UIcmdWith3Vector("/rect/pos/rot1", this);
+  rot1Cmd->SetGuidance("Set the x' axis of the source plane (default: 1 0 0).");
+  rot1Cmd->SetParameterName("x", "y", "z", false);
+  rot1Cmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  rot1Cmd->SetToBeBroadcasted(false);
+
+  rot2Cmd = new G4UIcmdWith3Vector("/rect/pos/rot2", this);
+  rot2Cmd->SetGuidance("Set a vector in the x'y' plane of the source (default: 0 1 0); y' is made orthogonal to x'.");
+  rot2Cmd->SetParameterName("x", "y", "z", false);
+  rot2Cmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  rot2Cmd->SetToBeBroadcasted(false);
+
+  angDir = new G4UIdirectory("/rect/ang/");
+  angDir->SetGuidance(" Angular distribution (focused).");
+
+  focusCmd = new G4UIcmdWith3VectorAndUnit("/rect/ang/focuspoint", this);
+  focusCmd->SetGuidance("Direct all particles through this point.");
+  focusCmd->SetParameterName("x", "y", "z", false);
+  focusCmd->SetDefaultUnit("cm");
+  focusCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  focusCmd->SetToBeBroadcasted(false);
+
+  eneDir = new G4UIdirectory("/rect/ene/");
+  eneDir->SetGuidance(" Energy distribution.");
+
+  monoCmd = new G4UIcmdWithADoubleAndUnit("/rect/ene/mono", this);
+  monoCmd->SetGuidance("Mono-energetic beam (replaces the spectrum).");
+  monoCmd->SetParameterName("energy", false);
+  monoCmd->SetRange("energy>0.");
+  monoCmd->SetDefaultUnit("MeV");
+  monoCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  monoCmd->SetToBeBroadcasted(false);
+
+  histDir = new G4UIdirectory("/rect/hist/");
+  histDir->SetGuidance(" Energy spectrum.");
+
+  histFileCmd = new G4UIcmdWithAString("/rect/hist/file", this);
+  histFileCmd->SetGuidance("Read the spectrum points (energy [MeV], density per line) as /gps/hist/file with");
+  histFileCmd->SetGuidance("  /gps/ene/type Arb and /gps/hist/inter Lin; energies are sampled through an alias table.");
+  histFileCmd->SetParameterName("fname", false);
+  histFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  histFileCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RectSourceMessenger::~RectSourceMessenger()
+{
+    delete   enableCmd;
+    delete   particleCmd;
+    delete   listCmd;
+    delete   centreCmd;
+    delete   halfxCmd;
+    delete   halfyCmd;
+    delete   rot1Cmd;
+    delete   rot2Cmd;
+    delete   posDir;
+    delete   focusCmd;
+    delete   angDir;
+    delete   monoCmd;
+    delete   eneDir;
+    delete   histFileCmd;
+    delete   histDir;
+	delete   Dir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RectSourceMessenger::SetNewValue(G4UIcommand* command,G4String newValue) {
+    if (command == enableCmd) {
+        fSource->SetEnabled(enableCmd->GetNewBoolValue(newValue));
+    } else if (command == particleCmd) {
+        G4ParticleDefinition* particle = G4ParticleTable::GetParticleTable()->FindParticle(newValue);
+        if (particle) {
+            fSource->SetParticle(particle);
+        } else {
+            G4cerr << "Error: particle \"" << newValue << "\" not found" << G4endl;
+        }
+    } else if (command == listCmd) {
+        fSource->Print();
+    } else if (command == centreCmd) {
+        fSource->SetCentre(centreCmd->GetNew3VectorValue(newValue));
+    } else if (command == halfxCmd) {
+        fSource->SetHalfX(halfxCmd->GetNewDoubleValue(newValue));
+    } else if (command == halfyCmd) {
+        fSource->SetHalfY(halfyCmd->GetNewDoubleValue(newValue));
+    } else if (command == rot1Cmd) {
+        fSource->SetRot1(rot1Cmd->GetNew3VectorValue(newValue));
+    } else if (command == rot2Cmd) {
+        fSource->SetRot2(rot2Cmd->GetNew3VectorValue(newValue));
+    } else if (command == focusCmd) {
+        fSource->SetFocusPoint(focusCmd->GetNew3VectorValue(newValue));
+    } else if (command == monoCmd) {
+        fSource->SetMonoEnergy(monoCmd->GetNewDoubleValue(newValue));
+    } else if (command == histFileCmd) {
+        fSource->ReadSpectrum(newValue);
+    }
+}
@@ -0,0 +1,124 @@
+#include "RegionOfInterest.hh"
+
+#include <fstream>
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RegionOfInterest::RegionOfInterest()
+    : fMode(kNone),
+    fMargin(0),
+    fExpanded(false),
+    fBuilt(false)
+{
+    for (G4int ax=0; ax<3; ++ax) {
+        fBoxLo[ax] = fBoxHi[ax] = 0;
+        fLo[ax] = fN[ax] = 0;
+    }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RegionOfInterest::SetBox(G4int ix0, G4int iy0, G4int iz0, G4int ix1, G4int iy1, G4int iz1)
+{
+    fMode = kBox;
+    fBoxLo[0] = std::min(ix0, ix1); fBoxHi[0] = std::max(ix0, ix1);
+    fBoxLo[1] = std::min(iy0, iy1); fBoxHi[1] = std::max(iy0, iy1);
+    fBoxLo[2] = std::min(iz0, iz1); fBoxHi[2] = std::max(iz0, iz1);
+    fBuilt = false;
+}
+
+void RegionOfInterest::SetMaskFile(const G4String& fname)
+{
+    fMode = kMask;
+    fMaskFile = fname;
+    fBuilt = false;
+}
+
+void RegionOfInterest::Clear()
+{
+    fMode = kNone;
+    fBuilt = false;
+    fMask.clear();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RegionOfInterest::Build(G4int nx, G4int ny, G4int nz)
+{
+    fBuilt = false;
+    fMask.clear();
+    if (fMode == kNone) { return; }
+
+    G4int n[3] = {nx, ny, nz};
+    G4long nxyz = (G4long)nx*ny*nz;
+    std::vector<char> full;
+    G4int lo[3], hi[3];
+
+    if (fMode == kBox) {
+        for (G4int ax=0; ax<3; ++ax) { lo[ax] = fBoxLo[ax]; hi[ax] = fBoxHi[ax]; }
+    } else {
+        std::ifstream infile(fMaskFile.c_str(), std::ios::in | std::ios::binary);
+        full.resize(nxyz);
+        if (!infile.read(&full[0], nxyz)) {
+            G4cerr << "ROI mask \"" << fMaskFile << "\" could not be read or holds fewer than " << nxyz << " voxels; scoring the full phantom" << G4endl;
+            return;
+        }
+        for (G4int ax=0; ax<3; ++ax) { lo[ax] = n[ax]; hi[ax] = -1; }
+        for (G4int iz=0; iz<nz; ++iz) {
+            for (G4int iy=0; iy<ny; ++iy) {
+                for (G4int ix=0; ix<nx; ++ix) {
+                    if (!full[(G4long)iz*ny*nx + iy*nx + ix]) { continue; }
+                    lo[0] = std::min(lo[0], ix); hi[0] = std::max(hi[0], ix);
+                    lo[1] = std::min(lo[1], iy); hi[1] = std::max(hi[1], iy);
+                    lo[2] = std::min(lo[2], iz); hi[2] = std::max(hi[2], iz);
+                }
+            }
+        }
+        if (hi[0] < 0) {
+            G4cerr << "ROI mask \"" << fMaskFile << "\" is empty; scoring the full phantom" << G4endl;
+            return;
+        }
+    }
+
+    // grow by the margin and clamp to the phantom
+    for (G4int ax=0; ax<3; ++ax) {
+        fLo[ax] = std::max(0, lo[ax] - fMargin);
+        fN[ax]  = std::min(n[ax]-1, hi[ax] + fMargin) - fLo[ax] + 1;
+        if (fN[ax] <= 0) {
+            G4cerr << "ROI box lies outside the phantom; scoring the full phantom" << G4endl;
+            return;
+        }
+    }
+
+    if (fMode == kMask) {
+        // copy the mask into the compact grid, then dilate by the margin (cube), one axis at a time
+        fMask.assign((G4long)fN[0]*fN[1]*fN[2], 0);
+        for (G4int iz=0; iz<fN[2]; ++iz) {
+            for (G4int iy=0; iy<fN[1]; ++iy) {
+                for (G4int ix=0; ix<fN[0]; ++ix) {
+                    fMask[(G4long)iz*fN[1]*fN[0] + iy*fN[0] + ix] =
+                        full[(G4long)(iz+fLo[2])*ny*nx + (iy+fLo[1])*nx + (ix+fLo[0])] ? 1 : 0;
+                }
+            }
+        }
+        G4long stride[3] = {1, fN[0], (G4long)fN[0]*fN[1]};
+        for (G4int ax=0; ax<3 && fMargin>0; ++ax) {
+            std::vector<char> src(fMask);
+            for (G4long idx=0; idx<(G4long)fMask.size(); ++idx) {
+                if (!src[idx]) { continue; }
+                G4int pos = (idx/stride[ax]) % fN[ax];
+                for (G4int d=std::max(0, pos-fMargin); d<=std::min(fN[ax]-1, pos+fMargin); ++d) {
+                    fMask[idx + (d-pos)*stride[ax]] = 1;
+                }
+            }
+        }
+    }
+    fBuilt = true;
+
+    G4long nscored = fMask.empty() ? (G4long)fN[0]*fN[1]*fN[2] : std::count(fMask.begin(), fMask.end(), 1);
+    G4cout << "Scoring region of interest:" << G4endl <<
+              "  Offset (voxels): " << fLo[0] << " " << fLo[1] << " " << fLo[2] << G4endl <<
+              "  Size (voxels): " << fN[0] << " " << fN[1] << " " << fN[2] << G4endl <<
+              "  Scored voxels: " << nscored << " of " << nxyz << " (" << 100.*nscored/nxyz << "%)" << G4endl;
+}
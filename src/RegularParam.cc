@@ -0,0 +1,10 @@
+#include "RegularParam.hh"
+#include "NavigationStats.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4Material* RegularParam::ComputeMaterial(const G4int copyNo, G4VPhysicalVolume* currentVol, const G4VTouchable* parentTouch)
+{
+	NavigationStats::CountComputeMaterial();
+	return G4PhantomParameterisation::ComputeMaterial(copyNo, currentVol, parentTouch);
+}
@@ -1,11 +1,16 @@
 
 #include "Run.hh"
+#include "DetectorConstruction.hh"
+#include "FusedScorer.hh"
+#include "SourceVertexInfo.hh"
 
 #include "G4SDManager.hh"
+#include "G4RunManager.hh"
 #include "G4THitsMap.hh"
 #include "G4MultiFunctionalDetector.hh"
 #include "G4VPrimitiveScorer.hh"
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
 #include "G4String.hh"
 
 #include <fstream>
@@ -13,6 +18,18 @@
 #include <string>
 
 Run::Run() {
+    const DetectorConstruction* detector = static_cast<const DetectorConstruction*>(
+            G4RunManager::GetRunManager()->GetUserDetectorConstruction());
+    if (detector) { spectra.Configure(detector->GetSpectrumBinning()); }
+    G4long tally_size = 0;
+    if (detector && detector->IsHistoryUncertainty()) {
+        // indexed like the hits maps: scoring grid, or compact region of interest
+        const RegionOfInterest& roi = detector->GetRegionOfInterest();
+        G4int sx, sy, sz;
+        detector->GetScoringGrid(sx, sy, sz);
+        tally_size = roi.IsEnabled() ? (G4long)roi.GetNx()*roi.GetNy()*roi.GetNz() : (G4long)sx*sy*sz;
+    }
+
 	G4SDManager *sdm = G4SDManager::GetSDMpointer();
 	G4MultiFunctionalDetector *mfd = static_cast<G4MultiFunctionalDetector*>(sdm->FindSensitiveDetector(mfd_name));
 
@@ -62,6 +79,11 @@ Run::Run() {
         infile.close();
     }
 
+    // beamlets are found from the primary vertex, so an event has to be a single history
+    if (!beamlet_specs.empty() && detector && detector->GetHistoriesPerEvent() > 1) {
+        G4cerr << "Warning: tracked beamlets are not scored with more than one history per event" << G4endl;
+        beamlet_specs.clear();
+    }
     for (const auto& blt : beamlet_specs) {
         tracked_beamlets[blt] = t_hitscoll();
     }
@@ -77,6 +99,12 @@ Run::Run() {
         //referencing a map by [] is an overloaded operator for implicitly inserting values if that element doesnt exist -.- sneaky bastards
         hitsmaps_by_name[full_name] = new t_hitsmap(mfd_name, scorer->GetName());
 
+        ScoreChannel* channel = dynamic_cast<ScoreChannel*>(scorer);
+        G4bool kermaDose = detector && detector->IsKermaRun() && scorer->GetName() == "dose3d";
+        if (tally_size > 0 && channel && channel->IsHistoryTally() && !kermaDose) {
+            history_tallies[scorer->GetName()].Configure(tally_size);
+        }
+
         for (const auto& blt : beamlet_specs) {
             tracked_beamlets[blt][full_name] = new t_hitsmap(mfd_name, scorer->GetName());
         }
@@ -108,6 +136,7 @@ void Run::RecordEvent(const G4Event* event)
     // mandatory
 	G4Run::RecordEvent(event);
 
+    navigation.computeMaterialCalls += NavigationStats::TakeComputeMaterialCalls();
 
 	G4HCofThisEvent* pHCE = event->GetHCofThisEvent();
 	if (!pHCE) {
@@ -170,16 +199,35 @@ void Run::Merge(const G4Run* thread_local_run) {
         }
     }
 
+    // per-region counters
+    if (region_stats.size() < local_run->region_stats.size()) {
+        region_stats.resize(local_run->region_stats.size());
+    }
+    for (size_t i=0; i<local_run->region_stats.size(); ++i) {
+        region_stats[i].steps += local_run->region_stats[i].steps;
+        region_stats[i].secondaries += local_run->region_stats[i].secondaries;
+    }
+    navigation.Merge(local_run->navigation);
+    profiler.Merge(local_run->profiler);
+    spectra.Merge(local_run->spectra);
+    for (const auto& it : local_run->history_tallies) {
+        history_tallies[it.first].Merge(it.second);
+    }
+
     // mandatory
 	G4Run::Merge(thread_local_run);
 }
 
 iTwoVector Run::GetBeamletNumber(const G4Event* event) {
     /* Only valid for AP beam with fluence map orthogonal to z-axis */
+    // position at the source, also for vertices moved to the phantom surface by fast-forwarding
+    const G4PrimaryVertex* vertex = event->GetPrimaryVertex();
+    const SourceVertexInfo* info = dynamic_cast<const SourceVertexInfo*>(vertex->GetUserInformation());
+    G4ThreeVector pos = info ? info->GetSourcePosition() : vertex->GetPosition();
     G4double x0, y0, z0;
-    x0 = event->GetPrimaryVertex()->GetX0();
-    y0 = event->GetPrimaryVertex()->GetY0();
-    z0 = event->GetPrimaryVertex()->GetZ0();
+    x0 = pos.x();
+    y0 = pos.y();
+    z0 = pos.z();
 
     int bx = (fmap_size.x-1) - floor(alpha*(x0 - fmap_center_pos.getX())/beamlet_size.x + (fmap_size.x/2.0));
     int by = (fmap_size.y-1) - floor(alpha*(y0 - alpha*fmap_center_pos.getY())/beamlet_size.y + (fmap_size.y/2.0));
@@ -7,19 +7,30 @@
 #include "G4SystemOfUnits.hh"
 #include "G4String.hh"
 #include "G4THitsMap.hh"
+#include "G4Region.hh"
+#include "G4RegionStore.hh"
+#include "G4Threading.hh"
+#include "G4ProcessTable.hh"
 
 #include "Run.hh"
 #include "DetectorConstruction.hh"
 #include "PrimaryGeneratorAction.hh"
-
-// from ../main.cc
-extern long int g_eventsProcessed;
-extern G4String g_geoFname;
+#include "TrackingAction.hh"
+#include "PhysicsList.hh"
+#include "ProgressReporter.hh"
+#include "ScoringWorld.hh"
+#include "Checkpoint.hh"
+#include "DoseEngine.hh"
 
 #include <string>
 #include <fstream>
+#include <sstream>
+#include <cstdio>
 #include <vector>
 #include <map>
+#include <iomanip>
+#include <algorithm>
+#include <cmath>
 #include <sys/stat.h>
 #include <unistd.h>
 
@@ -28,32 +39,15 @@ bool file_exists(const std::string& fname) {
     return stat(fname.c_str(), &buf) == 0;
 }
 
-RunAction::RunAction()
-{
-    // remind detector replica size (z is fastest index)
-    G4int nx, ny, nz;
-    {
-        G4String line;
-        std::stringstream ss;
-
-        std::ifstream infile;
-        infile.open(g_geoFname);
-
-        if (!infile.is_open()){
-            G4cerr << "Failed opening Geometry" << G4endl;
-            exit(1);
-        }
-        getline(infile, line);
-
-        ss.str(line);
-        // read header
-        ss >> nx >> ny >> nz; // nvoxels
-        infile.close();
-    }
-    det_size = {nx, ny, nz};
+long file_size(const std::string& fname) {
+    struct stat buf;
+    return stat(fname.c_str(), &buf) == 0 ? (long)buf.st_size : -1;
 }
 
-void RunAction::BeginOfRunAction(const G4Run*)
+RunAction::RunAction()
+{}
+
+void RunAction::BeginOfRunAction(const G4Run* run)
 {
 	/*
 	From Geant4 Manual:
@@ -61,8 +55,55 @@ void RunAction::BeginOfRunAction(const G4Run*)
 	or book histograms for a particular run. This method is invoked after the calculation of the physics tables.
 	*/
 
+    // remind scoring grid size (z is fastest index); may change between runs with /det/geo
+    const DetectorConstruction* detector = DetectorConstruction::getInstance();
+    detector->GetScoringGrid(det_size.x, det_size.y, det_size.z);
+
+    // after a restart, continue reading the phase-space files where this thread stopped
+    G4String sourceState;
+    if ((!IsMaster() || !G4Threading::IsMultithreadedApplication()) &&
+            Checkpoint::getInstance()->TakeThreadState(G4Threading::G4GetThreadId(), sourceState)) {
+        GetGenerator()->SetSourceState(sourceState);
+    }
+    if (!IsMaster() || !G4Threading::IsMultithreadedApplication()) {
+        UpdateTrackingAction();
+        // the weight window process of this thread only takes part in the stepping of runs that use it
+        const ImportanceMap& imap = DetectorConstruction::getInstance()->GetImportanceMap();
+        G4ProcessTable::GetProcessTable()->SetProcessActivation("weightWindow", "gamma", imap.IsEnabled() && imap.IsBuilt());
+    }
+
     if(IsMaster()){
+        G4Timer& initTimer = DoseEngine::getInstance()->GetInitTimer();
+        if (fRTally == 0) {
+            // physics tables are built by now
+            initTimer.Stop();
+            auto* physicsList = static_cast<PhysicsList*>(const_cast<G4VUserPhysicsList*>(G4RunManager::GetRunManager()->GetUserPhysicsList()));
+            DoseEngine::getInstance()->SetColdInitTime(initTimer.GetRealElapsed());
+            G4cout << "Initialization time: " << initTimer.GetRealElapsed() << " s (physics table cache: " << physicsList->GetTableCacheState() << ")" << G4endl;
+            physicsList->StoreTableCache();
+        } else if (detector->GetConstructCount() != fConstructCount) {
+            initTimer.Stop();
+            G4cout << "Geometry reload time: " << initTimer.GetRealElapsed() << " s" << G4endl;
+        }
+        fConstructCount = detector->GetConstructCount();
+
+        // kerma mode: mu_tr tables of all materials, once per geometry (before workers start their run)
+        auto* physicsList = static_cast<const PhysicsList*>(G4RunManager::GetRunManager()->GetUserPhysicsList());
+        if (physicsList->IsWoodcockEnabled() && detector->IsTrackLengthFluence()) {
+            G4cerr << "Warning: Woodcock photon steps cross voxel boundaries, photonFluenceTL is not scored per voxel" << G4endl;
+        }
+        KermaTable& kerma = DetectorConstruction::getInstance()->GetKermaTable();
+        if (kerma.IsEnabled()) {
+            if (!kerma.IsBuilt()) { kerma.Build(); }
+            if (physicsList->IsWoodcockEnabled()) {
+                G4cerr << "Warning: Woodcock photon steps cross voxel boundaries, kerma3d is not scored per voxel" << G4endl;
+            }
+            G4cout << "Kerma mode: secondary electrons are not transported, dose3d is not written in this run" << G4endl;
+        }
         fRTally++;
+        fRunTimer.Start();
+        ProgressReporter::getInstance()->Start(run->GetRunID(), run->GetNumberOfEventToBeProcessed(),
+                G4RunManager::GetRunManager()->GetNumberOfThreads());
         return;
     }
 }
@@ -75,24 +116,55 @@ void RunAction::EndOfRunAction(const G4Run *run)
 	the processed run.
 	*/
 
+    // source position of this thread for the next checkpoint (in sequential mode the master is the only "worker")
+    if (Checkpoint::getInstance()->IsEnabled() && (!IsMaster() || !G4Threading::IsMultithreadedApplication())) {
+        Checkpoint::getInstance()->SetThreadState(G4Threading::G4GetThreadId(), GetGenerator()->GetSourceState());
+    }
+
     if( ! IsMaster()){
 		G4cout<<"End of Run - worker thread terminated"<<G4endl;
         return;
     }
 	//If we're here, should be master thread, collect all of the worker tallies
-    long int nEventsThisRun = G4RunManager::GetRunManager()->GetCurrentRun()->GetNumberOfEventToBeProcessed();
-    g_eventsProcessed += nEventsThisRun;
-    G4cout << nEventsThisRun << " events processed in this run ("<<g_eventsProcessed<<" events in processed so far in the simulation)" << G4endl;
+    fRunTimer.Stop();
+    ProgressReporter::getInstance()->Stop();
+    // events actually processed: runs interrupted for a checkpoint end early
+    long int nEventsThisRun = run->GetNumberOfEvent();
+    DoseEngine::getInstance()->AddEventsProcessed(nEventsThisRun);
+    G4cout << nEventsThisRun << " events processed in this run ("<<DoseEngine::getInstance()->GetEventsProcessed()<<" events in processed so far in the simulation)" << G4endl;
+    if (nEventsThisRun < run->GetNumberOfEventToBeProcessed()) {
+        G4cout << "Run interrupted after " << nEventsThisRun << " of " << run->GetNumberOfEventToBeProcessed() << " events" << G4endl;
+    }
+    G4cout << "Run time: " << fRunTimer.GetRealElapsed() << " s (" << run->GetNumberOfEvent()/fRunTimer.GetRealElapsed() << " events/s)" << G4endl;
+    PrintRegionStats(static_cast<const Run*>(run));
+    PrintNavigationStats(static_cast<const Run*>(run));
+#ifdef PROFILE_STEPS
+    if (!G4Threading::IsMultithreadedApplication()) {
+        // sequential mode: no worker runs are merged, fold the counters of this run into its own tables
+        fRun->profiler.Merge(fRun->profiler);
+    }
+    fRun->profiler.Print();
+    fRun->profiler.WriteCSV("profile.csv");
+#endif
     G4cout << "Updating measurement output files..." << G4endl;
 
 	G4SDManager *sdm = G4SDManager::GetSDMpointer();
 	G4MultiFunctionalDetector *mfd =static_cast<G4MultiFunctionalDetector*>(sdm->FindSensitiveDetector(mfd_name));
 	if (!mfd) { return; }
 
+    if (!DoseEngine::getInstance()->IsMemoryOutput()) {
+        WriteRoiInfo();
+        WriteMeshInfo();
+    }
+    UpdateSpectra(fRun);
+
     auto *_run = static_cast<const Run*>(run);
     // output full beam
     G4cout << "writing results for \"Full Beam\"" << G4endl;
     UpdateOutput(mfd, _run->hitsmaps_by_name, "");
+    if (!fRun->history_tallies.empty()) {
+        UpdateUncertainty(fRun, nEventsThisRun*DetectorConstruction::getInstance()->GetHistoriesPerEvent());
+    }
 
     // output single beamlet
     for (const auto& hitsmaps : _run->tracked_beamlets) {
@@ -101,69 +173,264 @@ void RunAction::EndOfRunAction(const G4Run *run)
     }
 }
 
+void RunAction::UpdateTrackingAction() {
+    // a call per track, only made when the histories of an event have to be told apart (or for the step profiler);
+    // the tracking action registered with the run manager of this thread is deleted with it
+    const DetectorConstruction* detector = DetectorConstruction::getInstance();
+    G4bool needed = detector->GetHistoriesPerEvent() > 1 && detector->IsHistoryUncertainty();
+#ifdef PROFILE_STEPS
+    needed = true;
+#endif
+    if (needed == (fTrackingAction != nullptr)) { return; }
+    if (needed) {
+        fTrackingAction = new TrackingAction(this);
+        G4RunManager::GetRunManager()->SetUserAction(fTrackingAction);
+    } else {
+        G4RunManager::GetRunManager()->SetUserAction(static_cast<G4UserTrackingAction*>(nullptr));
+        delete fTrackingAction;
+        fTrackingAction = nullptr;
+    }
+}
+
+PrimaryGeneratorAction* RunAction::GetGenerator() const {
+    return const_cast<PrimaryGeneratorAction*>(static_cast<const PrimaryGeneratorAction*>(
+                G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction()));
+}
+
 void RunAction::UpdateOutput(const G4MultiFunctionalDetector* mfd, const std::map<G4String, G4THitsMap<G4double>*>& hitsmaps, G4String fsuffix) {
+	// dose3d of a kerma run only has the local photon deposits, it is not added to the dose of full transport runs
+	G4bool kermaRun = DetectorConstruction::getInstance()->IsKermaRun();
+	for (G4int ii=0; ii < mfd->GetNumberOfPrimitives(); ++ii) {
+		G4VPrimitiveScorer* scorer = mfd->GetPrimitive(ii);
+		if (kermaRun && scorer->GetName() == "dose3d") { continue; }
+		UpdateOutputFile(scorer->GetName() + fsuffix, *hitsmaps.at(mfd_name + "/" + scorer->GetName()));
+	}
+}
+
+void RunAction::UpdateOutputFile(const G4String& name, const G4THitsMap<G4double>& energy_deposits) {
+    // hits are indexed in the scoring grid: the full phantom, or the compact grid of the region of interest
+    const RegionOfInterest& roi = DetectorConstruction::getInstance()->GetRegionOfInterest();
+    iThreeVector score_size = det_size;
+    iThreeVector offset{0, 0, 0};
+    if (roi.IsEnabled()) {
+        score_size = {roi.GetNx(), roi.GetNy(), roi.GetNz()};
+        offset = {roi.GetOffsetX(), roi.GetOffsetY(), roi.GetOffsetZ()};
+    }
+    G4bool expand = roi.IsEnabled() && roi.IsExpandedOutput();
+    iThreeVector out_size = expand ? det_size : score_size;
+
+	// library use (DoseEngine::SetMemoryOutput): hits are added straight into the engine's buffers, no files
+	DoseEngine* engine = DoseEngine::getInstance();
+	G4bool memory = engine->IsMemoryOutput();
+
 	//make empty containers to hold our data
 	G4double dmax = 0;
-	G4double *data = new G4double[det_size.size()];
-	memset(data, 0, sizeof(G4double)*det_size.size());
-
-	G4VPrimitiveScorer* scorer;
-	G4THitsMap<G4double>* energy_deposits;
+	G4double *data;
+	if (memory) {
+		data = engine->OutputBuffer(name, out_size.x, out_size.y, out_size.z).data();
+	} else {
+		data = new G4double[out_size.size()];
+		memset(data, 0, sizeof(G4double)*out_size.size());
+	}
 
-	for (G4int ii=0; ii < mfd->GetNumberOfPrimitives(); ++ii) {
-		memset(data, 0, sizeof(G4double)*det_size.size());
-		dmax = 0;
-		scorer = mfd->GetPrimitive(ii);
-		energy_deposits = hitsmaps.at(mfd_name + "/" + scorer->GetName());
-
-		for (G4int ix = 0; ix < det_size.x; ++ix) {
-			for (G4int iy = 0; iy < det_size.y; ++iy) {
-				for (G4int iz = 0; iz < det_size.z; ++iz) {
-                    // G4long copyfrom = ix*det_size.y*det_size.z + iy*det_size.z + iz; // XYZ ordering
-                    G4long copyto = iz*det_size.y*det_size.x + iy*det_size.x + ix; // ZYX ordering
-                    G4long copyfrom = copyto;
-					G4double* energy_deposit = (*energy_deposits)[copyfrom];
-					G4double value = 0;
-					if (energy_deposit) {
-						value = (*energy_deposit);
-						data[copyto] += value;
-					}
-					if (value>dmax) {
-						dmax = value;
-                    }
-				}
-			}
-		}
-		G4cout << "Processed hits map for scorer " << "\"mfd/" + scorer->GetName() << "\" with size: (" << det_size.z << ", " << det_size.y << ", " << det_size.x << ") and max: " << dmax << G4endl;
-
-        // read previous checkpoint output, and add to it before writing this checkpoint output
-        G4String fname = G4String(scorer->GetName() + fsuffix + ".bin");
-        if (file_exists(fname)) {
-            std::ifstream infile(fname.c_str(), std::ios::in | std::ios::binary);
-            if (infile.fail()) {
-                G4cerr << "Error opening dose input file \""<<fname<<"\"" << G4endl;
-            } else {
-                G4double* tempdata = new G4double[det_size.size()];
-                infile.read((char*)tempdata, det_size.size()*sizeof(G4double));
-
-                for (G4long idx=0; idx<det_size.size(); idx++) {
-                    data[idx] += tempdata[idx];
-                }
-                delete[] tempdata;
-                infile.close();
-            }
+	// only voxels that received hits are stored in the map
+	for (const auto& hit : *energy_deposits.GetMap()) {
+        G4long copyfrom = hit.first; // ZYX ordering in the scoring grid
+        G4long copyto = copyfrom;
+        if (expand) {
+            G4int ix = copyfrom % score_size.x;
+            G4int iy = (copyfrom / score_size.x) % score_size.y;
+            G4int iz = copyfrom / ((G4long)score_size.x*score_size.y);
+            copyto = (iz+offset.z)*det_size.y*det_size.x + (iy+offset.y)*det_size.x + (ix+offset.x);
+        }
+        if (copyfrom < 0 || copyto >= out_size.size()) { continue; }
+        G4double value = *hit.second;
+        data[copyto] += value;
+        if (value>dmax) {
+            dmax = value;
         }
+	}
+	G4cout << "Processed hits map for scorer " << "\"mfd/" + name << "\" with size: (" << out_size.z << ", " << out_size.y << ", " << out_size.x << ") and max: " << dmax << G4endl;
+	if (memory) { return; }
 
-		std::ofstream outfile(fname.c_str(), std::ios::out | std::ios::binary);
-		if (outfile.fail()) {
-			G4cerr << "Error opening dose output file \""<<fname<<"\"" << G4endl;
+    // read previous checkpoint output, and add to it before writing this checkpoint output
+    G4String fname = name + ".bin";
+    // outputs of another region of interest are overwritten (reported by WriteRoiInfo())
+    G4bool accumulate = file_exists(fname) && !fOverwriteOutputs;
+    if (accumulate && file_size(fname) != out_size.size()*(long)sizeof(G4double)) {
+        // left over from a phantom of a different size (see /det/geo)
+        G4cerr << "Warning: existing output \""<<fname<<"\" does not match the phantom size and is overwritten" << G4endl;
+    } else if (accumulate) {
+        std::ifstream infile(fname.c_str(), std::ios::in | std::ios::binary);
+        if (infile.fail()) {
+            G4cerr << "Error opening dose input file \""<<fname<<"\"" << G4endl;
         } else {
-            outfile.write((char*)data, det_size.size() * sizeof(G4double));
-            outfile.close();
+            G4double* tempdata = new G4double[out_size.size()];
+            infile.read((char*)tempdata, out_size.size()*sizeof(G4double));
+
+            for (G4long idx=0; idx<out_size.size(); idx++) {
+                data[idx] += tempdata[idx];
+            }
+            delete[] tempdata;
+            infile.close();
         }
-	}
+    }
+
+	std::ofstream outfile(fname.c_str(), std::ios::out | std::ios::binary);
+	Checkpoint::getInstance()->AddOutput(fname);
+	if (outfile.fail()) {
+		G4cerr << "Error opening dose output file \""<<fname<<"\"" << G4endl;
+    } else {
+        outfile.write((char*)data, out_size.size() * sizeof(G4double));
+        outfile.close();
+    }
 	delete[] data;
+}
+
+void RunAction::UpdateUncertainty(Run* run, G4long histories) {
+    // <name>_sq: per-history sum of squares, cumulative over runs like <name>; histories.txt: number of histories
+    for (auto& tally : run->history_tallies) {
+        tally.second.Finish();
+        const std::vector<G4double>& sum2 = tally.second.GetSumOfSquares();
+        t_hitsmap sq(mfd_name, tally.first + "_sq");
+        for (size_t i=0; i<sum2.size(); ++i) {
+            G4double value = sum2[i];
+            if (value > 0) { sq.set((G4int)i, value); }
+        }
+        UpdateOutputFile(tally.first + "_sq", sq);
+    }
+
+    // relative standard error of the mean dose of this run, averaged over voxels above half the maximum
+    auto it = run->hitsmaps_by_name.find(mfd_name + "/dose3d");
+    auto tally = run->history_tallies.find("dose3d");
+    if (it != run->hitsmaps_by_name.end() && tally != run->history_tallies.end() && histories > 1) {
+        const std::vector<G4double>& sum2 = tally->second.GetSumOfSquares();
+        G4double dmax = 0;
+        for (const auto& hit : *it->second->GetMap()) { dmax = std::max(dmax, *hit.second); }
+        G4double sumrel = 0;
+        G4long nvox = 0;
+        for (const auto& hit : *it->second->GetMap()) {
+            G4double sum = *hit.second;
+            if (sum < 0.5*dmax || hit.first < 0 || hit.first >= (G4int)sum2.size()) { continue; }
+            G4double mean = sum/histories;
+            G4double var = std::max(0., (sum2[hit.first]/histories - mean*mean)/(histories - 1));
+            sumrel += std::sqrt(var)/mean;
+            nvox++;
+        }
+        if (nvox > 0) {
+            G4cout << "Dose uncertainty of this run: " << 100.*sumrel/nvox << "% (mean relative standard error, " << nvox
+                << " voxels above 50% of max, " << histories << " histories)" << G4endl;
+        }
+    }
+    if (DoseEngine::getInstance()->IsMemoryOutput()) { return; }
+
+    G4long total = histories;
+    std::ifstream infile("histories.txt");
+    G4long previous;
+    if (!fOverwriteOutputs && infile >> previous) { total += previous; }
+    infile.close();
+    std::ofstream outfile("histories.txt");
+    Checkpoint::getInstance()->AddOutput("histories.txt");
+    outfile << total << G4endl;
+}
+
+void RunAction::WriteRoiInfo() {
+    // compact outputs are only meaningful together with their placement in the phantom
+    const RegionOfInterest& roi = DetectorConstruction::getInstance()->GetRegionOfInterest();
+    std::ostringstream info;
+    if (roi.IsEnabled()) {
+        info << "# ZYX ordering (x fastest); output " << (roi.IsExpandedOutput() ? "expanded" : "compact") << "\n";
+        info << "size " << roi.GetNx() << " " << roi.GetNy() << " " << roi.GetNz() << "\n";
+        info << "offset " << roi.GetOffsetX() << " " << roi.GetOffsetY() << " " << roi.GetOffsetZ() << "\n";
+        info << "phantom " << det_size.x << " " << det_size.y << " " << det_size.z << "\n";
+    }
+
+    // outputs of a different region of interest have the same size but another placement: they are not accumulated
+    fOverwriteOutputs = false;
+    if (file_exists("roi.txt")) {
+        std::ifstream infile("roi.txt");
+        std::ostringstream previous;
+        previous << infile.rdbuf();
+        fOverwriteOutputs = previous.str() != info.str();
+    } else if (roi.IsEnabled()) {
+        // outputs left over from a run without region of interest
+        fOverwriteOutputs = file_exists("dose3d.bin");
+    }
+    if (fOverwriteOutputs) {
+        G4cerr << "Warning: existing outputs were scored with a different region of interest (roi.txt) and are overwritten" << G4endl;
+    }
+
+    if (!roi.IsEnabled()) {
+        std::remove("roi.txt");
+        return;
+    }
+    std::ofstream outfile("roi.txt");
+    Checkpoint::getInstance()->AddOutput("roi.txt");
+    outfile << info.str();
+}
+
+void RunAction::WriteMeshInfo() const {
+    // outputs on a parallel world mesh do not follow the geometry file header
+    const ScoringWorld* mesh = DetectorConstruction::getInstance()->GetScoringWorld();
+    if (!mesh) { return; }
+    std::ofstream outfile("mesh.txt");
+    Checkpoint::getInstance()->AddOutput("mesh.txt");
+    outfile << "# ZYX ordering (x fastest); lengths in mm" << G4endl;
+    outfile << "size " << mesh->GetNx() << " " << mesh->GetNy() << " " << mesh->GetNz() << G4endl;
+    outfile << "voxel " << mesh->GetVoxelSize().x()/mm << " " << mesh->GetVoxelSize().y()/mm << " " << mesh->GetVoxelSize().z()/mm << G4endl;
+    outfile << "origin " << mesh->GetOrigin().x()/mm << " " << mesh->GetOrigin().y()/mm << " " << mesh->GetOrigin().z()/mm << G4endl;
+}
+
+void RunAction::UpdateSpectra(Run* run) const {
+    // sparse photon spectra: add the previous output (if compatible) and rewrite it in compact form
+    if (!run->spectra.IsEnabled()) { return; }
+    const RegionOfInterest& roi = DetectorConstruction::getInstance()->GetRegionOfInterest();
+    std::ostringstream grid;
+    if (roi.IsEnabled()) {
+        grid << roi.GetNx() << " " << roi.GetNy() << " " << roi.GetNz() << " (roi at " << roi.GetOffsetX() << " "
+            << roi.GetOffsetY() << " " << roi.GetOffsetZ() << ")";
+    } else {
+        grid << det_size.x << " " << det_size.y << " " << det_size.z;
+    }
+    const G4String prefix = "photonSpectrum";
+    if (file_exists(prefix + ".txt") && !run->spectra.Read(prefix, grid.str())) {
+        G4cerr << "Warning: existing output \"" << prefix << "\" does not match the spectrum binning or grid and is overwritten" << G4endl;
+    }
+    run->spectra.Print(prefix);
+    run->spectra.Write(prefix, grid.str());
+    Checkpoint::getInstance()->AddOutput(prefix + ".txt");
+    Checkpoint::getInstance()->AddOutput(prefix + ".bin");
+    Checkpoint::getInstance()->AddOutput(prefix + "_index.bin");
+}
+
+void RunAction::PrintRegionStats(const Run* run) const {
+    G4cout << "Steps and secondaries per region:" << G4endl;
+    G4cout << std::setw(28) << std::left << "  region" << std::setw(16) << std::right << "steps" << std::setw(16) << "secondaries" << G4endl;
+    for (const G4Region* region : *G4RegionStore::GetInstance()) {
+        G4int id = region->GetInstanceID();
+        if (id >= (G4int)run->region_stats.size() || run->region_stats[id].steps == 0) { continue; }
+        const RegionStats& stats = run->region_stats[id];
+        G4cout << "  " << std::setw(26) << std::left << region->GetName() << std::right
+            << std::setw(16) << stats.steps << std::setw(16) << stats.secondaries << G4endl;
+    }
+}
+
+void RunAction::PrintNavigationStats(const Run* run) const {
+    G4long steps = 0;
+    for (const RegionStats& stats : run->region_stats) {
+        steps += stats.steps;
+    }
+    const NavigationStats& nav = run->navigation;
+    if (steps == 0 || nav.tracks == 0) { return; }
 
+    // the run time per step covers everything done per step (stepping, navigation, scoring and user actions), also for
+    // geantinos; bench/navigation.sh subtracts a single-voxel phantom run to isolate the voxel navigation
+    G4double threadTime = fRunTimer.GetRealElapsed()*G4RunManager::GetRunManager()->GetNumberOfThreads();
+    G4cout << "Navigation (" << DetectorConstruction::getInstance()->GetPhantomType() << " phantom): "
+        << (G4double)steps/nav.tracks << " steps/track, "
+        << steps << " steps in " << threadTime << " s thread time, "
+        << 1e9*threadTime/steps << " ns/step per thread (stepping, navigation and scoring), "
+        << (G4double)nav.computeMaterialCalls/steps << " ComputeMaterial calls/step (" << nav.computeMaterialCalls << " total)" << G4endl;
 }
 
 Run* RunAction::GenerateRun()
@@ -176,5 +443,6 @@ Run* RunAction::GenerateRun()
 	A.k.a. The "run" class is a user-created class for holding data, and performing functions related to information
 	we want to collect during the run.  Consider it a data container for what we tally (with functions).
 	*/
-    return new Run();
+    fRun = new Run();
+    return fRun;
 }
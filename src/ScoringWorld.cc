@@ -0,0 +1,67 @@
+#include "ScoringWorld.hh"
+
+#include "G4Box.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4PVPlacement.hh"
+#include "G4PVReplica.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+ScoringWorld::ScoringWorld(const G4String& name)
+    : G4VUserParallelWorld(name),
+    fVoxelSize(2.5*mm, 2.5*mm, 2.5*mm),
+    fHasOrigin(false), fHasExtent(false)
+{
+    fN[0] = fN[1] = fN[2] = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScoringWorld::SetupGrid(const G4ThreeVector& phantomLo, const G4ThreeVector& phantomHi)
+{
+    fGridOrigin = fHasOrigin ? fOrigin : phantomLo;
+    G4ThreeVector extent = fHasExtent ? fExtent : phantomHi - phantomLo;
+    for (G4int ax=0; ax<3; ++ax) {
+        fN[ax] = std::max(1, (G4int)std::lround(extent[ax]/fVoxelSize[ax]));
+        fGridVoxel[ax] = extent[ax]/fN[ax];
+    }
+
+    G4cout << "Scoring mesh (parallel world \"" << GetName() << "\"):" << G4endl <<
+              "  Array size: " << fN[0] << " " << fN[1] << " " << fN[2] << G4endl <<
+              "  Voxel size (mm): " << fGridVoxel.x()/mm << " " << fGridVoxel.y()/mm << " " << fGridVoxel.z()/mm << G4endl <<
+              "  Lower corner (mm): " << fGridOrigin.x()/mm << " " << fGridOrigin.y()/mm << " " << fGridOrigin.z()/mm << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void ScoringWorld::Construct()
+{
+    G4LogicalVolume* lGhost = GetWorld()->GetLogicalVolume();
+
+    // materials of parallel world volumes are ignored (null); transport materials come from the mass world
+    G4double meshx = fN[0]*fGridVoxel.x();
+    G4double meshy = fN[1]*fGridVoxel.y();
+    G4double meshz = fN[2]*fGridVoxel.z();
+    G4ThreeVector center = fGridOrigin + 0.5*G4ThreeVector(meshx, meshy, meshz);
+
+    G4Box* sMesh = new G4Box("sMesh", meshx/2., meshy/2., meshz/2.);
+    G4LogicalVolume* lMesh = new G4LogicalVolume(sMesh, 0, "lMesh");
+    new G4PVPlacement(0, center, lMesh, "pMesh", lGhost, false, 0);
+
+    G4Box* sMeshZ = new G4Box("sMeshZ", meshx/2., meshy/2., fGridVoxel.z()/2.);
+    G4LogicalVolume* lMeshZ = new G4LogicalVolume(sMeshZ, 0, "lMeshZ");
+    new G4PVReplica("pMeshZ", lMeshZ, lMesh, kZAxis, fN[2], fGridVoxel.z());
+
+    G4Box* sMeshY = new G4Box("sMeshY", meshx/2., fGridVoxel.y()/2., fGridVoxel.z()/2.);
+    G4LogicalVolume* lMeshY = new G4LogicalVolume(sMeshY, 0, "lMeshY");
+    new G4PVReplica("pMeshY", lMeshY, lMeshZ, kYAxis, fN[1], fGridVoxel.y());
+
+    G4Box* sMeshX = new G4Box("sMeshX", fGridVoxel.x()/2., fGridVoxel.y()/2., fGridVoxel.z()/2.);
+    G4LogicalVolume* lMeshX = new G4LogicalVolume(sMeshX, 0, "lMeshX");
+    new G4PVReplica("pMeshX", lMeshX, lMeshY, kXAxis, fN[0], fGridVoxel.x());
+}
@@ -0,0 +1,137 @@
+#include "SparseSpectra.hh"
+
+#include "G4SystemOfUnits.hh"
+
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SparseSpectra::Configure(const SpectrumBinning& binning)
+{
+    fBinning = binning;
+    fSlots.clear();
+    fChunks.clear();
+    fDropped = fUnderflow = fOverflow = 0;
+    if (!IsEnabled()) { return; }
+
+    fLnEmin = std::log(fBinning.emin);
+    if (fBinning.log) {
+        fInvWidth = fBinning.nbins/(std::log(fBinning.emax) - fLnEmin);
+    } else {
+        fInvWidth = fBinning.nbins/(fBinning.emax - fBinning.emin);
+    }
+    fMaxSlots = (G4long)(fBinning.maxMemoryMB*1024*1024/(sizeof(G4double)*fBinning.nbins));
+}
+
+G4double* SparseSpectra::Histogram(G4int voxel, G4bool create)
+{
+    auto it = fSlots.find(voxel);
+    G4int slot;
+    if (it != fSlots.end()) {
+        slot = it->second;
+    } else {
+        if (!create || (G4long)fSlots.size() >= fMaxSlots) { return 0; }
+        slot = fSlots.size();
+        if (slot % kChunk == 0) {
+            fChunks.emplace_back(new G4double[(size_t)kChunk*fBinning.nbins]());
+        }
+        fSlots.emplace(voxel, slot);
+    }
+    return fChunks[slot/kChunk].get() + (size_t)(slot%kChunk)*fBinning.nbins;
+}
+
+G4double SparseSpectra::GetMemoryMB() const
+{
+    G4double histograms = (G4double)fChunks.size()*kChunk*fBinning.nbins*sizeof(G4double);
+    G4double index = (G4double)fSlots.size()*(sizeof(G4int)*2 + 2*sizeof(void*)); // approximate hash node size
+    return (histograms + index)/(1024*1024);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SparseSpectra::Merge(const SparseSpectra& other)
+{
+    if (!other.IsEnabled()) { return; }
+    for (const auto& it : other.fSlots) {
+        const G4double* src = other.fChunks[it.second/kChunk].get() + (size_t)(it.second%kChunk)*fBinning.nbins;
+        G4double* dst = Histogram(it.first, true);
+        if (!dst) {
+            for (G4int b=0; b<fBinning.nbins; ++b) { fDropped += src[b]; }
+            continue;
+        }
+        for (G4int b=0; b<fBinning.nbins; ++b) { dst[b] += src[b]; }
+    }
+    fDropped   += other.fDropped;
+    fUnderflow += other.fUnderflow;
+    fOverflow  += other.fOverflow;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4String SparseSpectra::Header(const G4String& grid) const
+{
+    std::ostringstream os;
+    os << "# per-voxel photon fluence spectra (passages, weighted); voxel indices in ZYX ordering of the scoring grid\n";
+    os << "bins " << fBinning.nbins << "\n";
+    os << "emin_MeV " << fBinning.emin/MeV << "\n";
+    os << "emax_MeV " << fBinning.emax/MeV << "\n";
+    os << "scale " << (fBinning.log ? "log" : "lin") << "\n";
+    os << "grid " << grid << "\n";
+    return os.str();
+}
+
+G4bool SparseSpectra::Read(const G4String& prefix, const G4String& grid)
+{
+    // previous output must use the same binning and grid; everything up to the voxel count is compared
+    std::ifstream info((prefix + ".txt").c_str());
+    if (!info.is_open()) { return false; }
+    std::string header, line;
+    while (std::getline(info, line) && line.compare(0, 7, "voxels ") != 0) { header += line + "\n"; }
+    if (header != Header(grid)) { return false; }
+
+    std::ifstream index((prefix + "_index.bin").c_str(), std::ios::in | std::ios::binary);
+    std::ifstream data((prefix + ".bin").c_str(), std::ios::in | std::ios::binary);
+    if (!index.is_open() || !data.is_open()) { return false; }
+
+    std::vector<G4double> hist(fBinning.nbins);
+    int32_t voxel;
+    while (index.read((char*)&voxel, sizeof(voxel))) {
+        if (!data.read((char*)hist.data(), hist.size()*sizeof(G4double))) {
+            G4cerr << "Spectrum file \"" << prefix << ".bin\" is shorter than its index; ignoring the rest" << G4endl;
+            return false;
+        }
+        G4double* dst = Histogram(voxel, true);
+        for (G4int b=0; b<fBinning.nbins; ++b) {
+            if (dst) { dst[b] += hist[b]; } else { fDropped += hist[b]; }
+        }
+    }
+    return true;
+}
+
+void SparseSpectra::Write(const G4String& prefix, const G4String& grid) const
+{
+    std::vector<std::pair<G4int, G4int>> order(fSlots.begin(), fSlots.end());
+    std::sort(order.begin(), order.end());
+
+    std::ofstream index((prefix + "_index.bin").c_str(), std::ios::out | std::ios::binary);
+    std::ofstream data((prefix + ".bin").c_str(), std::ios::out | std::ios::binary);
+    for (const auto& it : order) {
+        int32_t voxel = it.first;
+        index.write((const char*)&voxel, sizeof(voxel));
+        data.write((const char*)(fChunks[it.second/kChunk].get() + (size_t)(it.second%kChunk)*fBinning.nbins),
+                fBinning.nbins*sizeof(G4double));
+    }
+
+    std::ofstream info((prefix + ".txt").c_str());
+    info << Header(grid);
+    info << "voxels " << order.size() << G4endl;
+}
+
+void SparseSpectra::Print(const G4String& name) const
+{
+    G4cout << "Spectra \"" << name << "\": " << fSlots.size() << " voxels with histograms, " << GetMemoryMB() << " MB (limit "
+        << fBinning.maxMemoryMB << " MB); weight dropped " << fDropped << ", below range " << fUnderflow
+        << ", above range " << fOverflow << G4endl;
+}
@@ -0,0 +1,77 @@
+#include "SpectralFluenceSD.hh"
+#include "SparseSpectra.hh"
+#include "RegionOfInterest.hh"
+#include "Run.hh"
+
+#include "G4RunManager.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4Track.hh"
+#include "G4VTouchable.hh"
+#include "G4Gamma.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SpectralFluenceSD::SpectralFluenceSD(const G4String& name)
+    : G4VSensitiveDetector(name),
+    fNx(0), fNy(0), fNz(0),
+    fRoi(0), fFlatIndex(false), fSpectra(0),
+    fTrackID(-1), fEntryEnergy(0)
+{}
+
+void SpectralFluenceSD::SetGrid(G4int nx, G4int ny, G4int nz, const RegionOfInterest* roi, G4bool flatIndex)
+{
+    fNx = nx; fNy = ny; fNz = nz;
+    fFlatIndex = flatIndex;
+    fRoi = (roi && roi->IsEnabled()) ? roi : 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SpectralFluenceSD::Initialize(G4HCofThisEvent*)
+{
+    Run* run = static_cast<Run*>(G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+    fSpectra = (run && run->spectra.IsEnabled()) ? &run->spectra : 0;
+    fTrackID = -1;
+}
+
+G4bool SpectralFluenceSD::ProcessHits(G4Step* aStep, G4TouchableHistory*)
+{
+    if (!fSpectra || aStep->GetTrack()->GetDefinition() != G4Gamma::Definition()) { return false; }
+
+    G4StepPoint* pre = aStep->GetPreStepPoint();
+    G4bool enter = pre->GetStepStatus() == fGeomBoundary;
+    G4bool exit  = aStep->GetPostStepPoint()->GetStepStatus() == fGeomBoundary;
+    G4int  id    = aStep->GetTrack()->GetTrackID();
+    G4double ekin;
+    if (enter && exit) {
+        ekin = pre->GetKineticEnergy();
+    } else if (enter) {
+        fTrackID = id;
+        fEntryEnergy = pre->GetKineticEnergy();
+        return false;
+    } else if (exit && fTrackID == id) {
+        fTrackID = -1;
+        ekin = fEntryEnergy;
+    } else {
+        return false;
+    }
+
+    const G4VTouchable* touch = pre->GetTouchable();
+    G4int ix, iy, iz;
+    if (fFlatIndex) {
+        G4int copyNo = touch->GetReplicaNumber(0);
+        ix = copyNo % fNx;
+        iy = (copyNo / fNx) % fNy;
+        iz = copyNo / (fNx*fNy);
+    } else {
+        ix = touch->GetReplicaNumber(0);
+        iy = touch->GetReplicaNumber(1);
+        iz = touch->GetReplicaNumber(2);
+    }
+    G4int index = fRoi ? fRoi->CompactIndex(ix, iy, iz) : iz*fNy*fNx + iy*fNx + ix;
+    if (index < 0) { return false; }
+
+    fSpectra->Fill(index, ekin, pre->GetWeight());
+    return true;
+}
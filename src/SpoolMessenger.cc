@@ -0,0 +1,59 @@
+#include "SpoolMessenger.hh"
+#include "JobSpool.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SpoolMessenger::SpoolMessenger(JobSpool * spool)
+:fSpool(spool)
+{
+  Dir = new G4UIdirectory("/spool/");
+  Dir->SetGuidance(" Service mode: run jobs from a spool directory in this process.");
+
+  watchCmd = new G4UIcmdWithAString("/spool/watch", this);
+  watchCmd->SetGuidance("Run <name>.job files from this directory back to back until a \"stop\" file appears.");
+  watchCmd->SetGuidance("Job files hold \"macro <file>\", and optionally \"geometry <file>\" and \"output <dir>\" lines.");
+  watchCmd->SetParameterName("dir", false);
+  watchCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  watchCmd->SetToBeBroadcasted(false);
+
+  pollCmd = new G4UIcmdWithADoubleAndUnit("/spool/pollInterval", this);
+  pollCmd->SetGuidance("Time between scans of an empty spool directory (default: 1 s).");
+  pollCmd->SetParameterName("interval", false);
+  pollCmd->SetRange("interval>0");
+  pollCmd->SetDefaultUnit("s");
+  pollCmd->SetToBeBroadcasted(false);
+
+  idleCmd = new G4UIcmdWithADoubleAndUnit("/spool/idleTimeout", this);
+  idleCmd->SetGuidance("Stop watching after this long without jobs (0, the default, waits forever).");
+  idleCmd->SetParameterName("timeout", false);
+  idleCmd->SetRange("timeout>=0");
+  idleCmd->SetDefaultUnit("s");
+  idleCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+SpoolMessenger::~SpoolMessenger()
+{
+    delete   watchCmd;
+    delete   pollCmd;
+    delete   idleCmd;
+	delete   Dir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void SpoolMessenger::SetNewValue(G4UIcommand* command,G4String newValue) {
+    if (command == watchCmd) {
+        fSpool->Watch(newValue);
+    } else if (command == pollCmd) {
+        fSpool->SetPollInterval(pollCmd->GetNewDoubleValue(newValue)/s);
+    } else if (command == idleCmd) {
+        fSpool->SetIdleTimeout(idleCmd->GetNewDoubleValue(newValue)/s);
+    }
+}
@@ -0,0 +1,30 @@
+#include "StackingAction.hh"
+
+#include "G4Track.hh"
+#include "G4Electron.hh"
+#include "G4Positron.hh"
+
+#include "DetectorConstruction.hh"
+#include "KermaTable.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+StackingAction::StackingAction()
+	: fKermaTable(DetectorConstruction::getInstance()->GetKermaTable())
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+	// primaries are always transported (e.g. electron beams)
+	if (fKermaTable.IsEnabled() && track->GetParentID() > 0) {
+		const G4ParticleDefinition* particle = track->GetParticleDefinition();
+		if (particle == G4Electron::Definition() || particle == G4Positron::Definition()) {
+			return fKill;
+		}
+	}
+	return fUrgent;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
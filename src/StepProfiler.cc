@@ -0,0 +1,119 @@
+#include "StepProfiler.hh"
+
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4VProcess.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+
+#include <fstream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::BeginTrack(const G4Track* track)
+{
+    fParticles[track->GetDefinition()].tracks++;
+    // creation process and volume of the track; primaries have no creator process
+    fProcesses[track->GetCreatorProcess()].tracks++;
+    fVolumes[track->GetVolume() ? track->GetVolume()->GetLogicalVolume() : nullptr].tracks++;
+    fStamp = clock::now();
+}
+
+void StepProfiler::EndStep(const G4Step* step)
+{
+    clock::time_point now = clock::now();
+    G4double dt = std::chrono::duration<G4double>(now - fStamp).count();
+    fStamp = now;
+
+    Counters& particle = fParticles[step->GetTrack()->GetDefinition()];
+    particle.steps++;
+    particle.time += dt;
+
+    Counters& process = fProcesses[step->GetPostStepPoint()->GetProcessDefinedStep()];
+    process.steps++;
+    process.time += dt;
+
+    Counters& volume = fVolumes[step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()];
+    volume.steps++;
+    volume.time += dt;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+static void add(StepProfiler::Counters& to, const StepProfiler::Counters& from) {
+    to.steps  += from.steps;
+    to.tracks += from.tracks;
+    to.time   += from.time;
+}
+
+void StepProfiler::Merge(const StepProfiler& other)
+{
+    for (const auto& it : other.fParticles) {
+        add(fParticleTable[it.first->GetParticleName()], it.second);
+    }
+    for (const auto& it : other.fProcesses) {
+        add(fProcessTable[it.first ? it.first->GetProcessName() : G4String("primary/none")], it.second);
+    }
+    for (const auto& it : other.fVolumes) {
+        add(fVolumeTable[it.first ? it.first->GetName() : G4String("none")], it.second);
+    }
+}
+
+G4bool StepProfiler::IsEmpty() const
+{
+    return fParticleTable.empty() && fParticles.empty();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void StepProfiler::Print() const
+{
+    const std::pair<const char*, const t_table*> tables[] = {
+        {"particle", &fParticleTable}, {"process", &fProcessTable}, {"volume", &fVolumeTable}};
+
+    for (const auto& table : tables) {
+        G4double total = 0;
+        for (const auto& it : *table.second) { total += it.second.time; }
+
+        // most expensive first
+        std::vector<std::pair<G4String, Counters>> rows(table.second->begin(), table.second->end());
+        std::sort(rows.begin(), rows.end(), [](const std::pair<G4String, Counters>& a, const std::pair<G4String, Counters>& b) {
+            return a.second.time > b.second.time;
+        });
+
+        G4cout << "Tracking profile by " << table.first << " (all threads):" << G4endl;
+        G4cout << "  " << std::setw(26) << std::left << table.first << std::right << std::setw(14) << "steps"
+            << std::setw(12) << "tracks" << std::setw(12) << "time [s]" << std::setw(9) << "time %" << std::setw(12) << "ns/step" << G4endl;
+        for (const auto& row : rows) {
+            const Counters& c = row.second;
+            G4cout << "  " << std::setw(26) << std::left << row.first << std::right << std::setw(14) << c.steps
+                << std::setw(12) << c.tracks << std::setw(12) << std::fixed << std::setprecision(3) << c.time
+                << std::setw(9) << std::setprecision(1) << (total > 0 ? 100.*c.time/total : 0.)
+                << std::setw(12) << std::setprecision(1) << (c.steps ? 1e9*c.time/c.steps : 0.)
+                << std::defaultfloat << std::setprecision(6) << G4endl;
+        }
+    }
+}
+
+void StepProfiler::WriteCSV(const G4String& fname) const
+{
+    std::ofstream outfile(fname);
+    if (!outfile.is_open()) {
+        G4cerr << "Failed writing profile to \"" << fname << "\"" << G4endl;
+        return;
+    }
+    outfile << "category,name,steps,tracks,time_s" << std::endl;
+    outfile << std::setprecision(9);
+    const std::pair<const char*, const t_table*> tables[] = {
+        {"particle", &fParticleTable}, {"process", &fProcessTable}, {"volume", &fVolumeTable}};
+    for (const auto& table : tables) {
+        for (const auto& it : *table.second) {
+            outfile << table.first << "," << it.first << "," << it.second.steps << "," << it.second.tracks << "," << it.second.time << std::endl;
+        }
+    }
+}
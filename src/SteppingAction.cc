@@ -5,9 +5,17 @@
 #include "G4RunManager.hh"
 #include "G4StepPoint.hh"
 
+#include "G4LogicalVolume.hh"
+#include "G4Region.hh"
+#include "G4VPhysicalVolume.hh"
+
+#include "RunAction.hh"
+#include "Run.hh"
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-SteppingAction::SteppingAction()
+SteppingAction::SteppingAction(const RunAction* runAction)
+	: fRunAction(runAction)
 {}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -27,6 +35,21 @@ void SteppingAction::UserSteppingAction(const G4Step* step)
 	G4cout << step->GetTrack()->GetVolume()->GetName() << G4endl;
 	G4cout << step->GetTrack()->GetVertexKineticEnergy() << G4endl;
 	*/
+
+	// per-region step and secondary counts, in a flat array indexed by region
+	t_region_stats& regions = fRunAction->GetRun()->region_stats;
+	G4int id = step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume()->GetRegion()->GetInstanceID();
+	if (id >= (G4int)regions.size()) { regions.resize(id+1); }
+	RegionStats& stats = regions[id];
+	stats.steps++;
+	stats.secondaries += step->GetSecondaryInCurrentStep()->size();
+	if (step->GetTrack()->GetCurrentStepNumber() == 1) {
+		++fRunAction->GetRun()->navigation.tracks;
+	}
+
+#ifdef PROFILE_STEPS
+	fRunAction->GetRun()->profiler.EndStep(step);
+#endif
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,31 @@
+#include "TrackingAction.hh"
+
+#include "G4Track.hh"
+
+#include "RunAction.hh"
+#include "Run.hh"
+#include "HistoryTally.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+TrackingAction::TrackingAction(const RunAction* runAction)
+	: fRunAction(runAction)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void TrackingAction::PreUserTrackingAction(const G4Track* track)
+{
+	// primaries get track IDs 1..K in the order they were generated; secondaries are followed after their parent started
+	G4int id = track->GetTrackID();
+	G4int parent = track->GetParentID();
+	if (id >= (G4int)fPrimaryOf.size()) { fPrimaryOf.resize(2*id); }
+	fPrimaryOf[id] = parent == 0 ? id-1 : fPrimaryOf[parent];
+	HistoryTally::SetPrimary(fPrimaryOf[id]);
+
+#ifdef PROFILE_STEPS
+	fRunAction->GetRun()->profiler.BeginTrack(track);
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,21 @@
+#include "WeightWindowPhysics.hh"
+#include "WeightWindowProcess.hh"
+
+#include "G4Gamma.hh"
+#include "G4ProcessManager.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WeightWindowPhysics::WeightWindowPhysics(const G4String& name)
+	: G4VPhysicsConstructor(name)
+{}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WeightWindowPhysics::ConstructProcess()
+{
+	G4ProcessManager* manager = G4Gamma::Definition()->GetProcessManager();
+	manager->AddDiscreteProcess(new WeightWindowProcess(), ordLast);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
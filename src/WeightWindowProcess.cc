@@ -0,0 +1,46 @@
+#include "WeightWindowProcess.hh"
+
+#include "G4Gamma.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+
+#include "DetectorConstruction.hh"
+#include "ImportanceMap.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WeightWindowProcess::WeightWindowProcess(const G4String& name)
+	: G4VProcess(name, fGeneral),
+	fImportanceMap(DetectorConstruction::getInstance()->GetImportanceMap())
+{
+	pParticleChange = &fParticleChange;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool WeightWindowProcess::IsApplicable(const G4ParticleDefinition& particle)
+{
+	return &particle == G4Gamma::Definition();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double WeightWindowProcess::PostStepGetPhysicalInteractionLength(const G4Track&, G4double, G4ForceCondition* condition)
+{
+	// never limits the step, but is invoked at the end of each one
+	*condition = StronglyForced;
+	return DBL_MAX;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4VParticleChange* WeightWindowProcess::PostStepDoIt(const G4Track& track, const G4Step& step)
+{
+	fParticleChange.Initialize(track);
+	if (fImportanceMap.IsEnabled() && fImportanceMap.IsBuilt()) {
+		fImportanceMap.ApplyWeightWindow(step, fParticleChange);
+	}
+	return &fParticleChange;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
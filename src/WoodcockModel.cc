@@ -0,0 +1,236 @@
+#include "WoodcockModel.hh"
+
+#include "G4FastTrack.hh"
+#include "G4FastStep.hh"
+#include "G4Track.hh"
+#include "G4Step.hh"
+#include "G4StepPoint.hh"
+#include "G4DynamicParticle.hh"
+#include "G4VParticleChange.hh"
+#include "G4ParticleChangeForGamma.hh"
+#include "G4VProcess.hh"
+#include "G4ProcessManager.hh"
+#include "G4ProcessVector.hh"
+#include "G4EmCalculator.hh"
+#include "G4ProductionCutsTable.hh"
+#include "G4Region.hh"
+#include "G4Material.hh"
+#include "G4Gamma.hh"
+#include "G4Electron.hh"
+#include "G4VSolid.hh"
+#include "G4RandomDirection.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <cmath>
+#include <algorithm>
+#include <cfloat>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WoodcockModel::WoodcockModel(const G4String& name, G4Region* envelope, G4int nx, G4int ny, G4int nz, G4double dx,
+        G4double dy, G4double dz, const std::vector<G4int>& matMap, const std::vector<G4Material*>& matVec)
+    : G4VFastSimulationModel(name, envelope),
+    fRegion(envelope),
+    fNx(nx), fNy(ny), fNz(nz),
+    fDx(dx), fDy(dy), fDz(dz),
+    fMatMap(matMap), fMatVec(matVec),
+    fTablesBuilt(false),
+    fNbins(500), fEmin(1*keV), fEmax(100*MeV)
+{
+    fLnEmin = std::log(fEmin);
+    fInvDlnE = (fNbins-1)/(std::log(fEmax) - fLnEmin);
+
+    fTmpTrack = new G4Track(new G4DynamicParticle(G4Gamma::Definition(), G4ThreeVector(0, 0, 1), 1*MeV), 0, G4ThreeVector());
+    fTmpStep = new G4Step();
+    fTmpStep->NewSecondaryVector();
+    fTmpStep->SetTrack(fTmpTrack);
+    fTmpTrack->SetStep(fTmpStep);
+}
+
+WoodcockModel::~WoodcockModel()
+{
+    delete fTmpStep;
+    delete fTmpTrack;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4bool WoodcockModel::IsApplicable(const G4ParticleDefinition& particle)
+{
+    return &particle == G4Gamma::Definition();
+}
+
+G4bool WoodcockModel::ModelTrigger(const G4FastTrack& fastTrack)
+{
+    // below the table range photons are left to the normal transport
+    return fastTrack.GetPrimaryTrack()->GetKineticEnergy() >= fEmin;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WoodcockModel::SetPhantom(G4int nx, G4int ny, G4int nz, G4double dx, G4double dy, G4double dz)
+{
+    fNx = nx; fNy = ny; fNz = nz;
+    fDx = dx; fDy = dy; fDz = dz;
+    // the material list may have changed with the phantom
+    fTablesBuilt = false;
+}
+
+void WoodcockModel::BuildTables()
+{
+    fProcesses.clear();
+    G4ProcessVector* pv = G4Gamma::Definition()->GetProcessManager()->GetPostStepProcessVector();
+    for (G4int i=0; i<(G4int)pv->size(); ++i) {
+        G4VProcess* proc = (*pv)[i];
+        if (proc->GetProcessType() == fElectromagnetic) { fProcesses.push_back(proc); }
+    }
+
+    G4EmCalculator calc;
+    G4ProductionCutsTable* cutsTable = G4ProductionCutsTable::GetProductionCutsTable();
+    G4int nmat = fMatVec.size();
+    fMuProcess.assign(nmat, std::vector<std::vector<G4double>>(fProcesses.size(), std::vector<G4double>(fNbins, 0)));
+    fMuTotal.assign(nmat, std::vector<G4double>(fNbins, 0));
+    fMuMax.assign(fNbins, 0);
+    fCouples.assign(nmat, nullptr);
+
+    for (G4int m=0; m<nmat; ++m) {
+        // materials of unused density indices are never created
+        if (!fMatVec[m]) { continue; }
+        fCouples[m] = cutsTable->GetMaterialCutsCouple(fMatVec[m], fRegion->GetProductionCuts());
+        for (G4int b=0; b<fNbins; ++b) {
+            G4double ekin = std::exp(fLnEmin + b/fInvDlnE);
+            for (size_t p=0; p<fProcesses.size(); ++p) {
+                G4double mu = calc.ComputeCrossSectionPerVolume(ekin, G4Gamma::Definition(), fProcesses[p]->GetProcessName(), fMatVec[m]);
+                fMuProcess[m][p][b] = mu;
+                fMuTotal[m][b] += mu;
+            }
+            // linear interpolation of the node-wise maximum bounds the interpolated cross section of every material
+            fMuMax[b] = std::max(fMuMax[b], fMuTotal[m][b]);
+        }
+    }
+    fTablesBuilt = true;
+
+    G4cout << "Woodcock tracking: " << fProcesses.size() << " photon processes, " << nmat << " materials, mu_max(1 MeV) = "
+        << Lookup(fMuMax, std::log(1*MeV))*cm << " 1/cm" << G4endl;
+}
+
+G4double WoodcockModel::Lookup(const std::vector<G4double>& table, G4double lnE) const
+{
+    G4double x = (lnE - fLnEmin)*fInvDlnE;
+    G4int b = std::min(fNbins-2, std::max(0, (G4int)x));
+    G4double f = std::min(1., std::max(0., x - b));
+    return table[b] + f*(table[b+1] - table[b]);
+}
+
+G4int WoodcockModel::VoxelMaterial(const G4ThreeVector& localPos) const
+{
+    // envelope is centered on its local origin
+    G4int ix = std::min(fNx-1, std::max(0, (G4int)((localPos.x() + 0.5*fNx*fDx)/fDx)));
+    G4int iy = std::min(fNy-1, std::max(0, (G4int)((localPos.y() + 0.5*fNy*fDy)/fDy)));
+    G4int iz = std::min(fNz-1, std::max(0, (G4int)((localPos.z() + 0.5*fNz*fDz)/fDz)));
+    return fMatMap[iz*fNy*fNx + iy*fNx + ix]; // ZYX ordering
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WoodcockModel::DoIt(const G4FastTrack& fastTrack, G4FastStep& fastStep)
+{
+    if (!fTablesBuilt) { BuildTables(); }
+
+    const G4Track* track = fastTrack.GetPrimaryTrack();
+    G4double ekin = track->GetKineticEnergy();
+    G4double lnE = std::log(ekin);
+    G4double time = track->GetGlobalTime();
+    G4ThreeVector pos = fastTrack.GetPrimaryTrackLocalPosition();
+    G4ThreeVector dir = fastTrack.GetPrimaryTrackLocalDirection();
+
+    G4double muMax = Lookup(fMuMax, lnE);
+    G4double toExit = fastTrack.GetEnvelopeSolid()->DistanceToOut(pos, dir);
+    G4double path = 0;
+
+    while (true) {
+        G4double s = (muMax > 0) ? -std::log(G4UniformRand())/muMax : DBL_MAX;
+        if (s >= toExit) {
+            // leaves the phantom without a real collision
+            path += toExit;
+            fastStep.ProposePrimaryTrackFinalPosition(pos + toExit*dir);
+            fastStep.ProposePrimaryTrackFinalTime(time + path/c_light);
+            fastStep.ProposePrimaryTrackPathLength(path);
+            return;
+        }
+        pos += s*dir;
+        toExit -= s;
+        path += s;
+
+        G4int mat = VoxelMaterial(pos);
+        G4double mu = Lookup(fMuTotal[mat], lnE);
+        if (G4UniformRand()*muMax < mu) {
+            fastStep.ProposePrimaryTrackPathLength(path);
+            Interact(fastTrack, fastStep, mat, ekin, pos, time + path/c_light, mu);
+            return;
+        }
+        // fictitious collision: continue with the same energy and direction
+    }
+}
+
+void WoodcockModel::Interact(const G4FastTrack& fastTrack, G4FastStep& fastStep, G4int mat, G4double ekin,
+        const G4ThreeVector& localPos, G4double time, G4double mu)
+{
+    // select the process in proportion to its share of the total cross section
+    G4double lnE = std::log(ekin);
+    G4double r = G4UniformRand()*mu;
+    size_t p = 0;
+    for (; p<fProcesses.size()-1; ++p) {
+        r -= Lookup(fMuProcess[mat][p], lnE);
+        if (r <= 0) { break; }
+    }
+    G4VProcess* proc = fProcesses[p];
+
+    // place the helper track at the collision point; EM processes take the material from the pre-step point
+    G4ThreeVector globalPos = fastTrack.GetInverseAffineTransformation()->TransformPoint(localPos);
+    G4ThreeVector globalDir = fastTrack.GetPrimaryTrack()->GetMomentumDirection();
+    G4DynamicParticle* dp = const_cast<G4DynamicParticle*>(fTmpTrack->GetDynamicParticle());
+    dp->SetKineticEnergy(ekin);
+    dp->SetMomentumDirection(globalDir);
+    fTmpTrack->SetPosition(globalPos);
+    fTmpTrack->SetGlobalTime(time);
+    fTmpTrack->SetWeight(fastTrack.GetPrimaryTrack()->GetWeight());
+    for (G4StepPoint* point : {fTmpStep->GetPreStepPoint(), fTmpStep->GetPostStepPoint()}) {
+        point->SetPosition(globalPos);
+        point->SetKineticEnergy(ekin);
+        point->SetMomentumDirection(globalDir);
+        point->SetMaterial(fMatVec[mat]);
+        point->SetMaterialCutsCouple(fCouples[mat]);
+    }
+
+    G4ForceCondition condition;
+    proc->PostStepGetPhysicalInteractionLength(*fTmpTrack, 0, &condition);
+    G4VParticleChange* change = proc->PostStepDoIt(*fTmpTrack, *fTmpStep);
+    G4ParticleChangeForGamma* gammaChange = static_cast<G4ParticleChangeForGamma*>(change);
+
+    G4double edep = change->GetLocalEnergyDeposit();
+    G4int nsec = change->GetNumberOfSecondaries();
+    fastStep.SetNumberOfSecondaryTracks(nsec + (edep > 0 ? 1 : 0));
+    for (G4int i=0; i<nsec; ++i) {
+        G4Track* sec = change->GetSecondary(i);
+        fastStep.CreateSecondaryTrack(*sec->GetDynamicParticle(), globalPos, time, false);
+        delete sec;
+    }
+    if (edep > 0) {
+        G4DynamicParticle local(G4Electron::Definition(), G4RandomDirection(), edep);
+        fastStep.CreateSecondaryTrack(local, globalPos, time, false);
+    }
+    change->Clear();
+
+    fastStep.ProposePrimaryTrackFinalPosition(localPos);
+    fastStep.ProposePrimaryTrackFinalTime(time);
+    G4double eout = gammaChange->GetProposedKineticEnergy();
+    if (change->GetTrackStatus() == fStopAndKill || eout <= 0) {
+        fastStep.KillPrimaryTrack();
+    } else {
+        fastStep.ProposePrimaryTrackFinalKineticEnergy(eout);
+        fastStep.ProposePrimaryTrackFinalMomentumDirection(gammaChange->GetProposedMomentumDirection(), false);
+    }
+}
@@ -0,0 +1,110 @@
+#include "WorkerInitialization.hh"
+#include "WorkerMessenger.hh"
+
+#include "G4Threading.hh"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <dirent.h>
+#include <unistd.h>
+#ifdef __linux__
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+// parse a kernel cpulist such as "0-7,16-23"
+static std::vector<G4int> parse_cpulist(const std::string& list) {
+    std::vector<G4int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+    while (std::getline(ss, range, ',')) {
+        G4int lo, hi;
+        char dash;
+        std::stringstream rs(range);
+        if (!(rs >> lo)) { continue; }
+        hi = (rs >> dash >> hi) ? hi : lo;
+        for (G4int cpu=lo; cpu<=hi; ++cpu) { cpus.push_back(cpu); }
+    }
+    return cpus;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WorkerInitialization::WorkerInitialization()
+    : fPolicy("none")
+{
+    fMessenger = new WorkerMessenger(this);
+    ReadTopology();
+}
+
+WorkerInitialization::~WorkerInitialization()
+{
+    delete fMessenger;
+}
+
+void WorkerInitialization::ReadTopology()
+{
+    const std::string root = "/sys/devices/system/node/";
+    for (G4int node=0; ; ++node) {
+        std::ifstream infile(root + "node" + std::to_string(node) + "/cpulist");
+        if (!infile.good()) { break; }
+        std::string line;
+        std::getline(infile, line);
+        std::vector<G4int> cpus = parse_cpulist(line);
+        if (!cpus.empty()) { fNodeCpus.push_back(cpus); }
+    }
+
+    if (fNodeCpus.empty()) {
+        std::vector<G4int> cpus;
+        for (G4int cpu=0; cpu<G4Threading::G4GetNumberOfCores(); ++cpu) { cpus.push_back(cpu); }
+        fNodeCpus.push_back(cpus);
+    }
+}
+
+void WorkerInitialization::PrintTopology() const
+{
+    G4cout << "NUMA nodes: " << fNodeCpus.size() << G4endl;
+    for (size_t node=0; node<fNodeCpus.size(); ++node) {
+        G4cout << "  node " << node << ": " << fNodeCpus[node].size() << " cpus (" << fNodeCpus[node].front()
+            << ".." << fNodeCpus[node].back() << ")" << G4endl;
+    }
+    G4cout << "Worker pinning: " << fPolicy << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WorkerInitialization::WorkerStart() const
+{
+    if (fPolicy == "none") { return; }
+
+#ifdef __linux__
+    G4int id = G4Threading::G4GetThreadId();
+    G4int nodes = fNodeCpus.size();
+
+    std::vector<G4int> cpus;
+    G4int node = 0;
+    if (fPolicy == "core") {
+        G4int ncpus = 0;
+        for (const auto& node_cpus : fNodeCpus) { ncpus += node_cpus.size(); }
+        G4int slot = id % ncpus;
+        while (slot >= (G4int)fNodeCpus[node].size()) { slot -= fNodeCpus[node].size(); ++node; }
+        cpus.push_back(fNodeCpus[node][slot]);
+    } else {
+        node = id % nodes;
+        cpus = fNodeCpus[node];
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (G4int cpu : cpus) { CPU_SET(cpu, &set); }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        G4cerr << "Worker " << id << ": failed setting CPU affinity" << G4endl;
+        return;
+    }
+    G4cout << "Worker " << id << " pinned to node " << node << " (" << cpus.size() << " cpu" << (cpus.size() > 1 ? "s" : "")
+        << ", first " << cpus.front() << ")" << G4endl;
+#else
+    G4cerr << "Worker pinning is only supported on linux" << G4endl;
+#endif
+}
@@ -0,0 +1,48 @@
+#include "WorkerMessenger.hh"
+#include "WorkerInitialization.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WorkerMessenger::WorkerMessenger(WorkerInitialization * workerInit)
+:fWorkerInit(workerInit)
+{
+  Dir = new G4UIdirectory("/mt/");
+  Dir->SetGuidance(" Worker thread placement.");
+
+  pinningCmd = new G4UIcmdWithAString("/mt/pinning", this);
+  pinningCmd->SetGuidance("Pin worker threads when they start (set before the first /run/beamOn).");
+  pinningCmd->SetGuidance("  none: no pinning");
+  pinningCmd->SetGuidance("  core: one cpu per worker, filling NUMA nodes in order");
+  pinningCmd->SetGuidance("  node: all cpus of one NUMA node per worker, round-robin over nodes");
+  pinningCmd->SetParameterName("policy", false);
+  pinningCmd->SetCandidates("none core node");
+  pinningCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+  pinningCmd->SetToBeBroadcasted(false);
+
+  topologyCmd = new G4UIcmdWithoutParameter("/mt/topology", this);
+  topologyCmd->SetGuidance("Print the NUMA nodes and the pinning policy.");
+  topologyCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+WorkerMessenger::~WorkerMessenger()
+{
+    delete   pinningCmd;
+    delete   topologyCmd;
+	delete   Dir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void WorkerMessenger::SetNewValue(G4UIcommand* command,G4String newValue) {
+    if (command == pinningCmd) {
+        fWorkerInit->SetPinning(newValue);
+    } else if (command == topologyCmd) {
+        fWorkerInit->PrintTopology();
+    }
+}
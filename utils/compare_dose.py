@@ -0,0 +1,55 @@
+######################################################################
+# compare_dose.py
+#
+# Description:  Compare two binary dose volumes (e.g. from different
+#               physics profiles) and report the dose difference
+#               relative to the reference maximum
+#
+# Dependencies: Numpy
+# Example usage:   'python compare_dose.py ref/dose3d.bin test/dose3d.bin phantom.txt'
+######################################################################
+
+import sys
+import os
+import numpy as np
+
+def print_usage():
+    print('Usage:  {!s} reference.bin test.bin geometry_file [--summary]'.format(os.path.basename(sys.argv[0])))
+
+def read_dims(geometry):
+    # first three values of the geometry file are the number of voxels: nx ny nz
+    with open(geometry, 'r') as f:
+        nx, ny, nz = [int(x) for x in f.readline().split()[:3]]
+    return nx, ny, nz
+
+def load_bin(path, dims):
+    nx, ny, nz = dims
+    arr = np.fromfile(path, dtype=np.float64)  # stored in double format
+    if arr.size != nx*ny*nz:
+        raise Exception('Expected {:d} voxels but read {:d} voxels from "{!s}"'.format(nx*ny*nz, arr.size, path))
+    return arr.reshape((nz, ny, nx))
+
+if len(sys.argv) < 4:
+    print_usage()
+    sys.exit(1)
+
+dims = read_dims(sys.argv[3])
+summary = '--summary' in sys.argv[4:]
+ref = load_bin(sys.argv[1], dims)
+test = load_bin(sys.argv[2], dims)
+
+dmax = np.max(ref)
+if dmax <= 0:
+    raise Exception('Reference dose "{!s}" is empty'.format(sys.argv[1]))
+diff = 100.0*np.abs(test - ref)/dmax
+# mean difference is evaluated where the reference dose is clinically relevant (>10% of max)
+mask = ref > 0.1*dmax
+max_diff = np.max(diff)
+mean_diff = np.mean(diff[mask])
+
+if summary:
+    print('{:14.3f} {:14.3f}'.format(max_diff, mean_diff))
+else:
+    print('voxels (>10% of max): {:d}'.format(int(np.count_nonzero(mask))))
+    print('max |dD| (% of ref max): {:.3f}'.format(max_diff))
+    print('mean |dD| (% of ref max, >10% of max): {:.3f}'.format(mean_diff))